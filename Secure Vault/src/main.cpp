@@ -7,6 +7,7 @@
 
 #define STB_EASY_FONT_IMPLEMENTATION
 #include "stb_easy_font.h"
+#include "trace.h"
 
 using namespace std;
 namespace fs = std::filesystem;
@@ -155,6 +156,7 @@ class SecureVault {
     fs::path ntPath(const string& id) const { return ntDir()/("note_"+safeFile(id)+".txt"); }
 
     void savePassword(const SensitiveData& it){
+        TRACE_SCOPE("savePassword");
         if(it.getType()!="Password") return;
         fs::create_directories(pwDir());
         auto dec = it.decryptedRows(key);
@@ -170,6 +172,7 @@ class SecureVault {
         cout<<"[Saved PW] "<<fs::absolute(pwPath(name)).string()<<endl;
     }
     void saveBackup(const SensitiveData& it){
+        TRACE_SCOPE("saveBackup");
         if(it.getType()!="BackupCode") return;
         fs::create_directories(bcDir());
         auto dec = it.decryptedRows(key);
@@ -185,6 +188,7 @@ class SecureVault {
         cout<<"[Saved BC] "<<fs::absolute(bcPath(acc)).string()<<endl;
     }
     void saveNote(const SensitiveData& it){
+        TRACE_SCOPE("saveNote");
         if(it.getType()!="QuickNote") return;
         fs::create_directories(ntDir());
         auto dec = it.decryptedRows(key);
@@ -259,6 +263,7 @@ public:
 
     // Loads
     int loadPasswords(){
+        TRACE_SCOPE("loadPasswords");
         int cnt=0; fs::path d=pwDir(); if(!fs::exists(d)) return 0;
         for(auto& e: fs::directory_iterator(d)){
             if(!e.is_regular_file()) continue;
@@ -271,6 +276,7 @@ public:
         return cnt;
     }
     int loadBackupCodes(){
+        TRACE_SCOPE("loadBackupCodes");
         int cnt=0; fs::path d=bcDir(); if(!fs::exists(d)) return 0;
         for(auto& e: fs::directory_iterator(d)){
             if(!e.is_regular_file()) continue;
@@ -283,6 +289,7 @@ public:
         return cnt;
     }
     int loadNotes(){
+        TRACE_SCOPE("loadNotes");
         int cnt=0; fs::path d=ntDir(); if(!fs::exists(d)) return 0;
         for(auto& e: fs::directory_iterator(d)){
             if(!e.is_regular_file()) continue;
@@ -431,7 +438,14 @@ public:
         return true;
     }
 
-    void run(){ while(!glfwWindowShouldClose(win)){ glfwPollEvents(); update(); render(); } }
+    void run(){
+        trace::setThreadName("main");
+        while(!glfwWindowShouldClose(win)){
+            TRACE_SCOPE("loop");
+            { TRACE_SCOPE("pollEvents"); glfwPollEvents(); }
+            update(); render();
+        }
+    }
     void shutdown(){ glfwDestroyWindow(win); glfwTerminate(); }
 
     // ---- UI builders ----
@@ -442,6 +456,7 @@ public:
     }
 
     void buildUI(){
+        TRACE_SCOPE("buildUI");
         clearInputs();
         switch(state){
             case LOGIN:{
@@ -722,6 +737,7 @@ public:
     }
 
     void render(){
+        TRACE_SCOPE("render");
         glClearColor(Theme::BACKGROUND.r,Theme::BACKGROUND.g,Theme::BACKGROUND.b,Theme::BACKGROUND.a);
         glClear(GL_COLOR_BUFFER_BIT);
         renderPanel();
@@ -782,12 +798,15 @@ public:
             Color c=statusCol; c.a*=statusAlpha;
             TextRenderer::print(status, 30, H-30, c);
         }
-        glfwSwapBuffers(win);
+        { TRACE_SCOPE("swapBuffers"); glfwSwapBuffers(win); }
     }
 };
 
-int main(){
+int main(int argc, char** argv){
     using namespace std;
+    // --trace FILE: Chrome trace of frames and file I/O, written on exit (build with -DENABLE_TRACE=ON)
+    string tracePath;
+    for(int i=1;i<argc;++i) if(!strcmp(argv[i],"--trace") && i+1<argc) tracePath=argv[++i];
     App app;
     if(!app.init()){ cerr<<"Failed to initialize application\n"; return -1; }
     cout<<"The application is running. Press ESC to exit.\n";
@@ -797,5 +816,9 @@ int main(){
     cout<<"Backup files:   "<<fs::absolute(fs::path("vault_data")/"BackupCodes").string()<<endl;
     cout<<"Notes files:    "<<fs::absolute(fs::path("vault_data")/"Notes").string()<<endl;
     app.run(); app.shutdown();
+    if(!tracePath.empty()){
+        if(trace::write(tracePath.c_str())) cout<<"[Saved trace] "<<fs::absolute(tracePath).string()<<endl;
+        else cerr<<"Failed to write "<<tracePath<<" (tracing needs a build with -DENABLE_TRACE=ON)\n";
+    }
     return 0;
 }
\ No newline at end of file
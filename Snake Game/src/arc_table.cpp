@@ -0,0 +1,53 @@
+#include "arc_table.h"
+
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+const int LEVELS = 6;  // 8, 16, ... 256 segments
+const float MAX_ERROR_PIXELS = 0.25f;
+
+struct ArcTables {
+    ArcPoint points[(8 << LEVELS) * 2];  // all levels back to back
+    int offset[LEVELS];
+    float maxRadius[LEVELS];  // largest on-screen radius each level serves
+
+    ArcTables() {
+        int at = 0;
+        for (int k = 0; k < LEVELS; ++k) {
+            int n = 8 << k;
+            offset[k] = at;
+            for (int i = 0; i <= n; ++i) {
+                double angle = 2.0 * M_PI * (i % n) / n;
+                points[at++] = ArcPoint{(float)cos(angle), (float)sin(angle)};
+            }
+            // A chord spanning 2*pi/n sits r*(1 - cos(pi/n)) inside the circle
+            maxRadius[k] = MAX_ERROR_PIXELS / (float)(1.0 - cos(M_PI / n));
+        }
+    }
+};
+
+const ArcTables& tables() {
+    static const ArcTables t;
+    return t;
+}
+
+}  // namespace
+
+int circleSegments(float radiusPixels) {
+    const ArcTables& t = tables();
+    int k = 0;
+    while (k < LEVELS - 1 && radiusPixels > t.maxRadius[k]) ++k;
+    return 8 << k;
+}
+
+const ArcPoint* unitCircle(int segments) {
+    const ArcTables& t = tables();
+    int k = 0;
+    while (k < LEVELS - 1 && (8 << k) < segments) ++k;
+    return t.points + t.offset[k];
+}
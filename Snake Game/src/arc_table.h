@@ -0,0 +1,14 @@
+#pragma once
+
+// Unit circle tessellations for the immediate-mode circle and rounded
+// rectangle code, computed once so drawing needs no trig. A level with n
+// segments holds n + 1 points at angles 2*pi*i/n (the last repeats the
+// first), so quarter k of the circle is the contiguous run from i = k*n/4.
+struct ArcPoint { float c, s; };
+
+// Fewest segments (8 to 256, always a multiple of 4) whose chords stay
+// within a quarter pixel of a circle of `radiusPixels` on screen
+int circleSegments(float radiusPixels);
+
+// Points of the level returned by circleSegments()
+const ArcPoint* unitCircle(int segments);
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+// Bitmap font shared by the GL game and the CPU renderer.
+// Only capital Latin A-Z (lower case maps to it), 0-9, colon, dot, dash, space.
+// Each glyph is 7 row bitmasks, bit 4 the leftmost of 5 columns, built at
+// compile time from the pictures below.
+struct Glyph { uint8_t rows[7]; };
+static_assert(sizeof(Glyph) == 7, "ShapeBatch and SoftRaster read the glyph table as 128 x 7 bytes");
+
+struct GlyphTable {
+    Glyph glyphs[128];
+    constexpr void set(char c, const char* r0, const char* r1, const char* r2, const char* r3,
+                       const char* r4, const char* r5, const char* r6) {
+        const char* rows[7] = {r0, r1, r2, r3, r4, r5, r6};
+        for (int r = 0; r < 7; r++) {
+            uint8_t bits = 0;
+            for (int col = 0; col < 5; col++) bits = (uint8_t)(bits << 1 | (rows[r][col] == '#'));
+            glyphs[(int)c].rows[r] = bits;
+            if (c >= 'A' && c <= 'Z') glyphs[c - 'A' + 'a'].rows[r] = bits;
+        }
+    }
+};
+
+constexpr GlyphTable buildGlyphTable() {
+    GlyphTable t{};
+    t.set('0', "#####", "#...#", "#...#", "#...#", "#...#", "#...#", "#####");
+    t.set('1', "..#..", ".##..", "..#..", "..#..", "..#..", "..#..", "#####");
+    t.set('2', "#####", "....#", "....#", "#####", "#....", "#....", "#####");
+    t.set('3', "#####", "....#", "....#", "#####", "....#", "....#", "#####");
+    t.set('4', "#...#", "#...#", "#...#", "#####", "....#", "....#", "....#");
+    t.set('5', "#####", "#....", "#....", "#####", "....#", "....#", "#####");
+    t.set('6', "#####", "#....", "#....", "#####", "#...#", "#...#", "#####");
+    t.set('7', "#####", "....#", "....#", "...#.", "..#..", ".#...", "#....");
+    t.set('8', "#####", "#...#", "#...#", "#####", "#...#", "#...#", "#####");
+    t.set('9', "#####", "#...#", "#...#", "#####", "....#", "....#", "#####");
+    t.set('A', ".###.", "#...#", "#...#", "#####", "#...#", "#...#", "#...#");
+    t.set('B', "####.", "#...#", "#...#", "####.", "#...#", "#...#", "####.");
+    t.set('C', ".####", "#....", "#....", "#....", "#....", "#....", ".####");
+    t.set('D', "####.", "#...#", "#...#", "#...#", "#...#", "#...#", "####.");
+    t.set('E', "#####", "#....", "#....", "####.", "#....", "#....", "#####");
+    t.set('F', "#####", "#....", "#....", "####.", "#....", "#....", "#....");
+    t.set('G', ".####", "#....", "#....", "#.###", "#...#", "#...#", ".####");
+    t.set('H', "#...#", "#...#", "#...#", "#####", "#...#", "#...#", "#...#");
+    t.set('I', "#####", "..#..", "..#..", "..#..", "..#..", "..#..", "#####");
+    t.set('J', "#####", "....#", "....#", "....#", "....#", "#...#", ".###.");
+    t.set('K', "#...#", "#..#.", "#.#..", "##...", "#.#..", "#..#.", "#...#");
+    t.set('L', "#....", "#....", "#....", "#....", "#....", "#....", "#####");
+    t.set('M', "#...#", "##.##", "#.#.#", "#...#", "#...#", "#...#", "#...#");
+    t.set('N', "#...#", "##..#", "#.#.#", "#..##", "#...#", "#...#", "#...#");
+    t.set('O', ".###.", "#...#", "#...#", "#...#", "#...#", "#...#", ".###.");
+    t.set('P', "####.", "#...#", "#...#", "####.", "#....", "#....", "#....");
+    t.set('Q', ".###.", "#...#", "#...#", "#...#", "#.#.#", "#..#.", ".##.#");
+    t.set('R', "####.", "#...#", "#...#", "####.", "#.#..", "#..#.", "#...#");
+    t.set('S', ".####", "#....", "#....", ".###.", "....#", "....#", "####.");
+    t.set('T', "#####", "..#..", "..#..", "..#..", "..#..", "..#..", "..#..");
+    t.set('U', "#...#", "#...#", "#...#", "#...#", "#...#", "#...#", ".###.");
+    t.set('V', "#...#", "#...#", "#...#", "#...#", ".#.#.", ".#.#.", "..#..");
+    t.set('W', "#...#", "#...#", "#...#", "#.#.#", "#.#.#", "##.##", "#...#");
+    t.set('X', "#...#", ".#.#.", "..#..", "..#..", "..#..", ".#.#.", "#...#");
+    t.set('Y', "#...#", ".#.#.", "..#..", "..#..", "..#..", "..#..", "..#..");
+    t.set('Z', "#####", "....#", "...#.", "..#..", ".#...", "#....", "#####");
+    t.set(':', ".....", "..#..", ".....", ".....", ".....", "..#..", ".....");
+    t.set('.', ".....", ".....", ".....", ".....", ".....", "..#..", ".....");
+    t.set('-', ".....", ".....", "#####", ".....", ".....", ".....", ".....");
+    return t;
+}
+
+inline constexpr GlyphTable FONT = buildGlyphTable();
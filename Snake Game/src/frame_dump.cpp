@@ -0,0 +1,200 @@
+#include "frame_dump.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+bool writePpm(const std::string& path, int width, int height, const uint8_t* rgba) {
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f) return false;
+    f << "P6\n" << width << " " << height << "\n255\n";
+    std::vector<uint8_t> row(3 * (size_t)width);
+    for (int y = height - 1; y >= 0; --y) {
+        const uint8_t* src = rgba + 4 * (size_t)width * y;
+        for (int x = 0; x < width; ++x) {
+            row[3 * x] = src[4 * x];
+            row[3 * x + 1] = src[4 * x + 1];
+            row[3 * x + 2] = src[4 * x + 2];
+        }
+        f.write((const char*)row.data(), row.size());
+    }
+    return (bool)f;
+}
+
+// ---- PNG ----
+static const int LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const int LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const int DIST_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+                                  1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const int DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+static const int MAX_MATCH = 258, MAX_DISTANCE = 32768;
+
+// Deflate bit stream: values go in least significant bit first, Huffman
+// codes most significant bit first
+struct BitWriter {
+    std::vector<uint8_t>& out;
+    uint32_t bits = 0;
+    int count = 0;
+
+    explicit BitWriter(std::vector<uint8_t>& out) : out(out) {}
+    void put(uint32_t value, int n) {
+        bits |= value << count;
+        count += n;
+        for (; count >= 8; count -= 8, bits >>= 8) out.push_back((uint8_t)bits);
+    }
+    void putCode(uint32_t code, int n) {
+        uint32_t reversed = 0;
+        for (int i = 0; i < n; ++i) reversed |= (code >> i & 1) << (n - 1 - i);
+        put(reversed, n);
+    }
+    void finish() {
+        if (count > 0) out.push_back((uint8_t)bits);
+        bits = 0, count = 0;
+    }
+};
+
+// Literal/length symbol in the fixed Huffman code
+static void putSymbol(BitWriter& w, int sym) {
+    if (sym < 144) w.putCode(0x30 + sym, 8);
+    else if (sym < 256) w.putCode(0x190 + sym - 144, 9);
+    else if (sym < 280) w.putCode(sym - 256, 7);
+    else w.putCode(0xc0 + sym - 280, 8);
+}
+
+static void putMatch(BitWriter& w, int length, int distance) {
+    int lc = 0;
+    while (lc < 28 && LENGTH_BASE[lc + 1] <= length) ++lc;
+    putSymbol(w, 257 + lc);
+    if (LENGTH_EXTRA[lc]) w.put(length - LENGTH_BASE[lc], LENGTH_EXTRA[lc]);
+    int dc = 0;
+    while (dc < 29 && DIST_BASE[dc + 1] <= distance) ++dc;
+    w.putCode(dc, 5);
+    if (DIST_EXTRA[dc]) w.put(distance - DIST_BASE[dc], DIST_EXTRA[dc]);
+}
+
+// zlib stream of `raw` as one fixed-Huffman block, each byte matched against
+// the previous pixel and the row above only
+static void deflate(const std::vector<uint8_t>& raw, size_t stride, std::vector<uint8_t>& out) {
+    out.push_back(0x78);
+    out.push_back(0x01);
+    BitWriter w(out);
+    w.put(1, 1);  // final block
+    w.put(1, 2);  // fixed Huffman codes
+    // The previous pixel first: on flat rows it already gives the longest match
+    const size_t distances[2] = {3, stride};
+    const uint8_t* data = raw.data();
+    size_t n = raw.size();
+    for (size_t pos = 0; pos < n;) {
+        size_t limit = std::min((size_t)MAX_MATCH, n - pos);
+        size_t best = 0, bestDistance = 0;
+        for (size_t d : distances) {
+            if (d > pos || d > (size_t)MAX_DISTANCE) continue;
+            const uint8_t* a = data + pos;
+            const uint8_t* b = a - d;
+            size_t len = 0;
+            for (uint64_t x, y; len + 8 <= limit; len += 8) {
+                memcpy(&x, a + len, 8);
+                memcpy(&y, b + len, 8);
+                if (x != y) break;
+            }
+            while (len < limit && a[len] == b[len]) ++len;
+            if (len > best) best = len, bestDistance = d;
+            if (best == limit) break;
+        }
+        if (best >= 3) {
+            putMatch(w, (int)best, (int)bestDistance);
+            pos += best;
+        } else putSymbol(w, data[pos++]);
+    }
+    putSymbol(w, 256);
+    w.finish();
+    // Adler-32, reducing modulo 65521 only every 5552 bytes (the most that
+    // cannot overflow 32 bits)
+    uint32_t a = 1, b = 0;
+    for (size_t pos = 0; pos < n;) {
+        size_t end = std::min(n, pos + 5552);
+        for (; pos < end; ++pos) {
+            a += data[pos];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    uint32_t adler = b << 16 | a;
+    for (int shift = 24; shift >= 0; shift -= 8) out.push_back((uint8_t)(adler >> shift));
+}
+
+struct CrcTable {
+    uint32_t entries[256];
+    CrcTable() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            entries[i] = c;
+        }
+    }
+};
+
+static uint32_t crc32(const uint8_t* data, size_t n, uint32_t crc) {
+    static const CrcTable table;
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = table.entries[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void putChunk(std::ofstream& f, const char* type, const std::vector<uint8_t>& data) {
+    uint8_t header[8];
+    uint32_t len = (uint32_t)data.size();
+    for (int i = 0; i < 4; ++i) header[i] = (uint8_t)(len >> (24 - 8 * i));
+    for (int i = 0; i < 4; ++i) header[4 + i] = (uint8_t)type[i];
+    uint32_t crc = crc32(header + 4, 4, 0);
+    crc = crc32(data.data(), data.size(), crc);
+    uint8_t trailer[4];
+    for (int i = 0; i < 4; ++i) trailer[i] = (uint8_t)(crc >> (24 - 8 * i));
+    f.write((const char*)header, 8);
+    f.write((const char*)data.data(), data.size());
+    f.write((const char*)trailer, 4);
+}
+
+bool writePng(const std::string& path, int width, int height, const uint8_t* rgba) {
+    // Filter byte 0 (none) then RGB for each row, top row first
+    size_t stride = 1 + 3 * (size_t)width;
+    std::vector<uint8_t> raw(stride * height);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* src = rgba + 4 * (size_t)width * (height - 1 - y);
+        uint8_t* dst = &raw[stride * y];
+        dst[0] = 0;
+        for (int x = 0; x < width; ++x) {
+            dst[1 + 3 * x] = src[4 * x];
+            dst[2 + 3 * x] = src[4 * x + 1];
+            dst[3 + 3 * x] = src[4 * x + 2];
+        }
+    }
+    std::vector<uint8_t> header(13, 0), compressed;
+    for (int i = 0; i < 4; ++i) {
+        header[i] = (uint8_t)(width >> (24 - 8 * i));
+        header[4 + i] = (uint8_t)(height >> (24 - 8 * i));
+    }
+    header[8] = 8;  // bits per channel
+    header[9] = 2;  // RGB
+    deflate(raw, stride, compressed);
+
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f) return false;
+    static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    f.write((const char*)SIGNATURE, 8);
+    putChunk(f, "IHDR", header);
+    putChunk(f, "IDAT", compressed);
+    putChunk(f, "IEND", std::vector<uint8_t>());
+    return (bool)f;
+}
+
+uint64_t frameChecksum(int width, int height, const uint8_t* rgba) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    size_t pixels = (size_t)width * height;
+    for (size_t i = 0; i < pixels; ++i)
+        for (int c = 0; c < 3; ++c) h = (h ^ rgba[4 * i + c]) * 0x100000001b3ULL;
+    return h;
+}
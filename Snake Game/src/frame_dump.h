@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Helpers for frames read back from GL or rendered on the CPU: `rgba` is
+// width * height RGBA8 pixels with the bottom row first, as glReadPixels
+// returns them.
+
+// Binary PPM (P6), top row first, alpha dropped
+bool writePpm(const std::string& path, int width, int height, const uint8_t* rgba);
+// RGB PNG, top row first, alpha dropped. Compressed with fixed-Huffman
+// deflate matching only against the previous pixel and the row above, which
+// is quick and catches the flat fills and gradients these frames are made of.
+bool writePng(const std::string& path, int width, int height, const uint8_t* rgba);
+// 64-bit FNV-1a of the RGB channels, for golden-image comparisons
+uint64_t frameChecksum(int width, int height, const uint8_t* rgba);
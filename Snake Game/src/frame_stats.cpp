@@ -0,0 +1,49 @@
+#include "frame_stats.h"
+
+#include <algorithm>
+
+DrawCounters drawCounters;
+ScopedTimer* ScopedTimer::active = nullptr;
+
+void FrameStats::endFrame() {
+    auto now = std::chrono::steady_clock::now();
+    frameMs[next] = std::chrono::duration<double, std::milli>(now - lastEnd).count();
+    lastEnd = now;
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+        phaseSum[p][next] = current[p];
+        current[p] = 0;
+    }
+    next = (next + 1) % WINDOW;
+    if (filled < WINDOW) ++filled;
+    calls = drawCounters.calls;
+    vertices = drawCounters.vertices;
+    drawCounters = DrawCounters();
+}
+
+double FrameStats::phaseMs(Phase phase) const {
+    if (!filled) return 0;
+    double sum = 0;
+    for (int i = 0; i < filled; ++i) sum += phaseSum[phase][i];
+    return sum * 1000.0 / filled;
+}
+
+double FrameStats::frameMsPercentile(double p) const {
+    if (!filled) return 0;
+    double sorted[WINDOW];
+    std::copy(frameMs, frameMs + filled, sorted);
+    int k = (int)(p * (filled - 1) + 0.5);
+    std::nth_element(sorted, sorted + k, sorted + filled);
+    return sorted[k];
+}
+
+ScopedTimer::ScopedTimer(FrameStats& s, FrameStats::Phase p)
+    : stats(s), phase(p), start(std::chrono::steady_clock::now()), parent(active) {
+    active = this;
+}
+
+ScopedTimer::~ScopedTimer() {
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.add(phase, elapsed - childSeconds);
+    if (parent) parent->childSeconds += elapsed;
+    active = parent;
+}
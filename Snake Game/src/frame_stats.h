@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+
+// GL draw calls and vertices submitted since the last frame ended. Every
+// draw path bumps these so the performance overlay can show what a frame
+// really costs.
+struct DrawCounters {
+    long long calls = 0, vertices = 0;
+    void add(long long vertexCount) { ++calls; vertices += vertexCount; }
+};
+extern DrawCounters drawCounters;
+
+// Per-phase frame timing over a rolling window of recent frames. Phases are
+// filled by ScopedTimer, which reports exclusive time: a timer nested in
+// another (sim inside update, text inside draw) is subtracted from its
+// parent, so the phases add up to the measured work of the frame.
+class FrameStats {
+public:
+    enum Phase { SIM, UPDATE, DRAW, TEXT, SWAP, PHASE_COUNT };
+    static const int WINDOW = 240;
+
+    void add(Phase phase, double seconds) { current[phase] += seconds; }
+    // Closes the frame at the end of the swap: the frame time runs from the
+    // previous swap, and the draw counters are taken and reset
+    void endFrame();
+
+    double lastFrameMs() const { return frameMs[(next + WINDOW - 1) % WINDOW]; }
+    // Mean of one phase over the window, in ms
+    double phaseMs(Phase phase) const;
+    // p-th percentile (0 to 1) of frame time over the window, in ms
+    double frameMsPercentile(double p) const;
+    long long lastDrawCalls() const { return calls; }
+    long long lastVertices() const { return vertices; }
+
+private:
+    double current[PHASE_COUNT] = {};
+    double phaseSum[PHASE_COUNT][WINDOW] = {};
+    double frameMs[WINDOW] = {};
+    int next = 0, filled = 0;
+    long long calls = 0, vertices = 0;
+    std::chrono::steady_clock::time_point lastEnd = std::chrono::steady_clock::now();
+};
+
+class ScopedTimer {
+public:
+    ScopedTimer(FrameStats& stats, FrameStats::Phase phase);
+    ~ScopedTimer();
+
+private:
+    FrameStats& stats;
+    FrameStats::Phase phase;
+    std::chrono::steady_clock::time_point start;
+    double childSeconds = 0;
+    ScopedTimer* parent;
+
+    static ScopedTimer* active;  // innermost running timer (timers are main-thread only)
+};
@@ -0,0 +1,45 @@
+#include "gl_program.h"
+
+#include <iostream>
+
+static GLuint compileShader(GLenum type, const char* source, const char* name) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    GLint ok = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[512];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        std::cerr << name << " shader failed to compile: " << log << "\n";
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint buildProgram(const char* vertexSource, const char* fragmentSource, const char* name) {
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexSource, name);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentSource, name);
+    if (!vs || !fs) {
+        if (vs) glDeleteShader(vs);
+        if (fs) glDeleteShader(fs);
+        return 0;
+    }
+    GLuint prog = glCreateProgram();
+    glAttachShader(prog, vs);
+    glAttachShader(prog, fs);
+    glLinkProgram(prog);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    GLint linked = 0;
+    glGetProgramiv(prog, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        char log[512];
+        glGetProgramInfoLog(prog, sizeof(log), NULL, log);
+        std::cerr << name << " shader failed to link: " << log << "\n";
+        glDeleteProgram(prog);
+        return 0;
+    }
+    return prog;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Compiles and links a vertex/fragment shader pair. On failure prints the
+// info log tagged with `name` and returns 0.
+GLuint buildProgram(const char* vertexSource, const char* fragmentSource, const char* name);
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "snake_sim.h"
+
+// Turns pressed between ticks, applied one per tick in the order they were
+// pressed, so up-then-left inside one tick becomes up on this tick and left
+// on the next instead of only the last key counting. Each turn is checked
+// against the direction the snake will be moving in when it applies (the
+// previous queued turn, or the current direction), so a quick up-left can
+// never be read as a reversal. Press times ride along so the game can
+// measure key-to-move latency.
+class InputQueue {
+public:
+    static const int CAPACITY = 3;  // more than this per tick is key mashing
+
+    // Queues `d` pressed at `time` while the snake moves in `current`;
+    // returns false when it is dropped as a repeat, a reversal or overflow
+    bool push(Direction d, double time, Direction current) {
+        Direction last = count ? dirs[(first + count - 1) % CAPACITY] : current;
+        if (d == last || d == opposite(last) || count == CAPACITY) return false;
+        int slot = (first + count++) % CAPACITY;
+        dirs[slot] = d;
+        times[slot] = time;
+        return true;
+    }
+
+    bool pop(Direction& d, double& time) {
+        if (!count) return false;
+        d = dirs[first];
+        time = times[first];
+        first = (first + 1) % CAPACITY;
+        --count;
+        return true;
+    }
+
+    void clear() { first = count = 0; }
+    bool empty() const { return count == 0; }
+
+private:
+    Direction dirs[CAPACITY];
+    double times[CAPACITY];
+    int first = 0, count = 0;
+};
@@ -0,0 +1,75 @@
+#include "latency_probe.h"
+
+#include <cstdio>
+
+static const char* STAGE_NAMES[] = {"press_to_tick", "tick_to_swap", "press_to_swap", "ui_press_to_swap"};
+
+void LatencyProbe::Histogram::add(double ms) {
+    int bucket = ms < 0 ? 0 : (int)ms;
+    if (bucket >= BUCKETS) bucket = BUCKETS - 1;
+    ++counts[bucket];
+    ++total;
+    sumMs += ms;
+    if (ms > maxMs) maxMs = ms;
+}
+
+// Upper edge of the bucket holding the p-th sample, so 1 ms resolution
+double LatencyProbe::Histogram::percentile(double p) const {
+    long long rank = (long long)(p * (total - 1) + 0.5), seen = 0;
+    for (int b = 0; b < BUCKETS; ++b) {
+        seen += counts[b];
+        if (seen > rank) return b + 1;
+    }
+    return BUCKETS;
+}
+
+void LatencyProbe::keyPressed(double time) {
+    if (pendingKeys < MAX_PENDING) keyPress[pendingKeys++] = time;
+}
+
+void LatencyProbe::turnApplied(double pressedAt, double time) {
+    stages[PRESS_TO_TICK].add((time - pressedAt) * 1000.0);
+    if (pendingTurns < MAX_PENDING) {
+        turnPressed[pendingTurns] = pressedAt;
+        turnTick[pendingTurns++] = time;
+    }
+}
+
+void LatencyProbe::frameSwapped(double time) {
+    for (int i = 0; i < pendingTurns; ++i) {
+        stages[TICK_TO_SWAP].add((time - turnTick[i]) * 1000.0);
+        stages[PRESS_TO_SWAP].add((time - turnPressed[i]) * 1000.0);
+    }
+    for (int i = 0; i < pendingKeys; ++i) stages[UI_PRESS_TO_SWAP].add((time - keyPress[i]) * 1000.0);
+    pendingTurns = pendingKeys = 0;
+}
+
+void LatencyProbe::printSummary() const {
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        const Histogram& h = stages[s];
+        if (!h.total) continue;
+        printf("[Latency] %-16s %6lld events  avg %.1f ms  p50 <%.0f ms  p99 <%.0f ms  max %.1f ms\n", STAGE_NAMES[s],
+               h.total, h.sumMs / h.total, h.percentile(0.5), h.percentile(0.99), h.maxMs);
+    }
+}
+
+bool LatencyProbe::write(const std::string& path, const std::string& settings) const {
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return false;
+    fprintf(f, "# snake input latency, %s\n", settings.c_str());
+    fprintf(f, "# stage count avg_ms p50_ms p99_ms max_ms\n");
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        const Histogram& h = stages[s];
+        fprintf(f, "# %s %lld %.2f %.0f %.0f %.2f\n", STAGE_NAMES[s], h.total, h.total ? h.sumMs / h.total : 0.0,
+                h.total ? h.percentile(0.5) : 0.0, h.total ? h.percentile(0.99) : 0.0, h.maxMs);
+    }
+    fprintf(f, "bucket_ms");
+    for (int s = 0; s < STAGE_COUNT; ++s) fprintf(f, " %s", STAGE_NAMES[s]);
+    fprintf(f, "\n");
+    for (int b = 0; b < BUCKETS; ++b) {
+        fprintf(f, "%d", b);
+        for (int s = 0; s < STAGE_COUNT; ++s) fprintf(f, " %lld", stages[s].counts[b]);
+        fprintf(f, "\n");
+    }
+    return fclose(f) == 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+
+// Input-to-photon timing for the game loop. Every key press is stamped in
+// the key callback; player turns are followed to the sim tick that applies
+// them and then to the first buffer swap after that tick, other keys (menus,
+// pause, seek) straight to the next swap. Each stage goes into a histogram
+// of 1 ms buckets, so recording never allocates.
+class LatencyProbe {
+public:
+    enum Stage { PRESS_TO_TICK, TICK_TO_SWAP, PRESS_TO_SWAP, UI_PRESS_TO_SWAP, STAGE_COUNT };
+
+    // A non-turn key press at `time` (seconds) that the next frame shows
+    void keyPressed(double time);
+    // A turn pressed at `pressedAt` was applied by the tick at `time`
+    void turnApplied(double pressedAt, double time);
+    // glfwSwapBuffers() returned at `time`: everything pending is on screen
+    void frameSwapped(double time);
+
+    // One line per stage on stdout
+    void printSummary() const;
+    // Per-stage statistics and the histograms as text columns; `settings`
+    // lands in the header comment so runs with different loop options can
+    // be told apart
+    bool write(const std::string& path, const std::string& settings) const;
+
+private:
+    static const int BUCKETS = 250;  // 0-249 ms, the last also takes anything slower
+    static const int MAX_PENDING = 32;
+
+    struct Histogram {
+        long long counts[BUCKETS] = {};
+        long long total = 0;
+        double sumMs = 0, maxMs = 0;
+        void add(double ms);
+        double percentile(double p) const;
+    };
+    Histogram stages[STAGE_COUNT];
+
+    // Waiting for a swap: turns (press and tick times) and other keys
+    double turnPressed[MAX_PENDING], turnTick[MAX_PENDING];
+    int pendingTurns = 0;
+    double keyPress[MAX_PENDING];
+    int pendingKeys = 0;
+};
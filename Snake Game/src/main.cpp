@@ -5,63 +5,122 @@
 #include <cmath>
 #include <iostream>
 #include <cstring>
-
-// Window and game constants
-const int WIDTH = 1000;
-const int HEIGHT = 800;
-const int CELL_SIZE = 20;
-const int TOP_UI_HEIGHT_PIXELS = 80;
-const int BOTTOM_UI_HEIGHT_PIXELS = 80;
-const float TOP_UI_HEIGHT_NDC = (float)TOP_UI_HEIGHT_PIXELS / HEIGHT * 2.0f;
-const float BOTTOM_UI_HEIGHT_NDC = (float)BOTTOM_UI_HEIGHT_PIXELS / HEIGHT * 2.0f;
-const float GAME_AREA_TOP_NDC = 1.0f - TOP_UI_HEIGHT_NDC;
-const float GAME_AREA_BOTTOM_NDC = -1.0f + BOTTOM_UI_HEIGHT_NDC;
-const float GAME_AREA_LEFT_NDC = -1.0f;
-const float GAME_AREA_RIGHT_NDC = 1.0f;
-const int GAME_AREA_PIXEL_WIDTH = WIDTH;
-const int GAME_AREA_PIXEL_HEIGHT = HEIGHT - TOP_UI_HEIGHT_PIXELS - BOTTOM_UI_HEIGHT_PIXELS;
-const int gridWidth = GAME_AREA_PIXEL_WIDTH / CELL_SIZE;
-const int gridHeight = GAME_AREA_PIXEL_HEIGHT / CELL_SIZE;
-const int MAX_SNAKE_LENGTH = gridWidth * gridHeight;
-
-// M_PI for some compilers
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
-enum Direction { UP, DOWN, LEFT, RIGHT };
-enum GameState { MENU, DIFFICULTY_SELECT, PLAYING, GAME_OVER, ABOUT, PAUSED };
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bitmap_font.h"
+#include "snake_autopilot.h"
+#include "snake_layer.h"
+#include "snake_scene.h"
+#include "frame_dump.h"
+#include "frame_stats.h"
+#include "input_queue.h"
+#include "latency_probe.h"
+#include "offscreen_layer.h"
+#include "shape_batch.h"
+#include "snake_replay.h"
+#include "snake_sim.h"
+#include "trace.h"
+
+// Board size (window layout and colours are in snake_scene.h). By default
+// CELL_SIZE pixel cells fill the game area; --grid WxH, a config file or a
+// replay picks anything up to MAX_GRID_SIDE a side at startup.
+int gridWidth = GAME_AREA_PIXEL_WIDTH / CELL_SIZE;
+int gridHeight = GAME_AREA_PIXEL_HEIGHT / CELL_SIZE;
+
+enum GameState { MENU, DIFFICULTY_SELECT, PLAYING, GAME_OVER, ABOUT, PAUSED, BOARD_COMPLETE };
 enum Difficulty { EASY, MEDIUM, HARD };
 
-struct Point { int x, y; };
-struct Color { float r, g, b, a; };
-
-const Color BG_COLOR        = {0.08f, 0.12f, 0.16f, 1.0f};
-const Color SNAKE_HEAD_COLOR= {0.5f, 0.4f, 0.3f, 1.0f};
-const Color SNAKE_BODY_COLOR= {0.15f, 0.5f, 0.25f, 1.0f};
-const Color FOOD_COLOR      = {1.0f, 1.0f, 1.0f, 1.0f};
-const Color UI_COLOR        = {0.1f, 0.2f, 0.3f, 0.9f};
-const Color TEXT_COLOR      = {0.85f, 0.9f, 1.0f, 1.0f};
-const Color ACCENT_COLOR    = {0.4f, 0.75f, 1.0f, 1.0f};
-const Color GAME_BORDER_COLOR = {0.15f, 0.3f, 0.5f, 1.0f};
-
-Point snake[MAX_SNAKE_LENGTH];
-int snakeLen = 0;
-Point food;
-Direction dir = RIGHT;
+SnakeSim sim(gridWidth, gridHeight);
+// + and - (or the mouse wheel) zoom the board, --zoom PX sets the starting
+// cell size. A board bigger than the game area at that size scrolls with
+// the head, and only the segments on screen are drawn.
+Camera camera;
+std::vector<int> visibleSegments;  // scratch for the culled snake
+// Game n of a session draws its food from stream n of this seed (--seed S to repeat a session)
+uint64_t sessionSeed = 0;
+uint64_t gamesStarted = 0;
+// Every game is recorded and written to replays/ when it ends; --replay FILE plays one back
+ReplayRecorder recorder;
+Replay loadedReplay;
+std::unique_ptr<ReplayPlayer> replayPlayer;
+// Everything is drawn through the shape batch, with the snake itself on the
+// GPU-resident snake layer. Both need GL 3.3, and the window asks for a 3.3
+// core context first; without one (or with --legacy-gl) the game falls back
+// to a compatibility context and the batch's immediate-mode path.
+ShapeBatch shapes;
+SnakeLayer snakeLayer;
+bool legacyGl = false;
+int framebufferWidth = WIDTH, framebufferHeight = HEIGHT;  // picks circle detail
+
+// Background, panels, labels and border of the game screen are drawn into an
+// offscreen layer and only redrawn when something they show changes
+struct HudKey {
+    int score, length, width, height;
+    Difficulty difficulty;
+    bool autopilot, replay;
+    bool operator==(const HudKey& o) const {
+        return score == o.score && length == o.length && width == o.width && height == o.height &&
+               difficulty == o.difficulty && autopilot == o.autopilot && replay == o.replay;
+    }
+};
+OffscreenLayer hudLayer;
+HudKey hudDrawn = {-1, -1, 0, 0, MEDIUM, false, false};
+const int REPLAY_SEEK_TICKS = 50;
+// Arrow keys queue turns that the sim consumes one per tick. Every key is
+// followed to the tick that applies it and the swap that shows it; with
+// --latency-log FILE the summary prints on exit and the histograms go to FILE.
+// Press times are taken when GLFW hands the event over, so time an event
+// waits in the OS queue before the loop polls is what --poll-before-tick
+// trades against.
+InputQueue turnQueue;
+LatencyProbe latency;
+std::string latencyLogPath;
+bool pollBeforeTick = false;
+// A toggles the bot while playing; its moves are recorded like the player's.
+// Its scratch grids are the board's size, so it is only built when first used.
+std::unique_ptr<Autopilot> autopilot;
+bool autopilotOn = false;
 GameState gameState = MENU;
 Difficulty difficulty = MEDIUM;
-int score = 0;
 int selectedMenuItem = 0;
 int selectedDifficulty = 1;
 float animationTime = 0.0f;
 float gameOverAnimation = 0.0f;
 
-const char* STUDENT_NAME = "TIJUL KABIR TOHA";
-const char* STUDENT_ID = "240113";
+// Frames are only drawn when the screen changes: a sim tick, input, a resize
+// or a running animation. In between the loop sleeps until the next tick,
+// the next animation frame or an input event.
+bool vsyncEnabled = true;  // --no-vsync to turn off
+double fpsCap = 0.0;       // --fps N; 0 leaves animation frames to vsync
+bool redrawRequested = true;
+
+// Fixed timestep: real time accumulates while PLAYING and each whole tick
+// interval in it runs one sim step, so game speed never drifts with the
+// frame rate. The leftover fraction of a tick (tickAlpha) slides the snake
+// from where it was before the last step to where it is now.
+const int MAX_TICKS_PER_FRAME = 8;  // after a stall, drop the backlog instead of fast-forwarding
+double tickAccumulator = 0.0;
+float tickAlpha = 1.0f;
+Point previousTail = {0, 0};  // tail cell before the last step
+int previousLength = 0;       // length before the last step, 0 = nothing to blend from
+
+// F3 shows frame time, where it goes and what the frame submits to GL. While
+// it is up every frame is drawn so the numbers keep moving.
+FrameStats frameStats;
+bool perfOverlay = false;
+// --trace FILE writes the loop, sim, draw and file I/O spans as Chrome trace
+// JSON on exit (needs a build with -DENABLE_TRACE=ON)
+std::string tracePath;
 
 // --- Utility ---
 double getUpdateInterval() {
+    if (replayPlayer) return loadedReplay.tickMillis / 1000.0;
     switch (difficulty) {
         case EASY: return 0.25;
         case MEDIUM: return 0.15;
@@ -70,160 +129,37 @@ double getUpdateInterval() {
     }
 }
 
-bool isSnakeAt(int x, int y) {
-    for (int i = 0; i < snakeLen; ++i)
-        if (snake[i].x == x && snake[i].y == y)
-            return true;
-    return false;
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    glViewport(0, 0, width, height);
+    framebufferWidth = width, framebufferHeight = height;
+    shapes.setViewport(width, height);
+    redrawRequested = true;
 }
 
-void placeFood() {
-    int x, y;
-    do {
-        x = rand() % gridWidth;
-        y = rand() % gridHeight;
-    } while (isSnakeAt(x, y));
-    food.x = x; food.y = y;
+void window_refresh_callback(GLFWwindow*) {
+    redrawRequested = true;
 }
 
-void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
-    glViewport(0, 0, width, height);
+void scroll_callback(GLFWwindow*, double, double yoffset) {
+    camera.zoom((float)std::pow(1.25, yoffset));
+    redrawRequested = true;
 }
 
 // ---- Drawing Primitives ----
 void drawGradientBackground() {
-    glBegin(GL_QUADS);
-    glColor4f(BG_COLOR.r * 1.2f, BG_COLOR.g * 1.2f, BG_COLOR.b * 1.2f, BG_COLOR.a);
-    glVertex2f(-1.0f, 1.0f); glVertex2f(1.0f, 1.0f);
-    glColor4f(BG_COLOR.r, BG_COLOR.g, BG_COLOR.b, BG_COLOR.a);
-    glVertex2f(1.0f, -1.0f); glVertex2f(-1.0f, -1.0f);
-    glEnd();
+    scene::background(shapes);
 }
 
 void drawRoundedRect(float x, float y, float width, float height, float radius, Color color) {
-    glColor4f(color.r, color.g, color.b, color.a);
-    glBegin(GL_QUADS);
-    glVertex2f(x + radius, y);
-    glVertex2f(x + width - radius, y);
-    glVertex2f(x + width - radius, y + height);
-    glVertex2f(x + radius, y + height);
-    glEnd();
-    glBegin(GL_QUADS);
-    glVertex2f(x, y + radius);
-    glVertex2f(x + radius, y + radius);
-    glVertex2f(x + radius, y + height - radius);
-    glVertex2f(x, y + height - radius);
-    glEnd();
-    glBegin(GL_QUADS);
-    glVertex2f(x + width - radius, y + radius);
-    glVertex2f(x + width, y + radius);
-    glVertex2f(x + width, y + height - radius);
-    glVertex2f(x + width - radius, y + height - radius);
-    glEnd();
-    int segments = 16;
-    for (int corner = 0; corner < 4; corner++) {
-        float cx, cy, start_angle_offset;
-        switch (corner) {
-            case 0: cx = x + radius; cy = y + radius; start_angle_offset = M_PI; break;
-            case 1: cx = x + width - radius; cy = y + radius; start_angle_offset = 1.5 * M_PI; break;
-            case 2: cx = x + width - radius; cy = y + height - radius; start_angle_offset = 0; break;
-            case 3: cx = x + radius; cy = y + height - radius; start_angle_offset = 0.5 * M_PI; break;
-        }
-        glBegin(GL_TRIANGLE_FAN);
-        glVertex2f(cx, cy);
-        for (int i = 0; i <= segments / 4; i++) {
-            float angle = start_angle_offset + (i * M_PI / 2) / (segments / 4);
-            glVertex2f(cx + radius * cos(angle), cy + radius * sin(angle));
-        }
-        glEnd();
-    }
-}
-
-void drawCircle(float x, float y, float radius, Color color) {
-    glColor4f(color.r, color.g, color.b, color.a);
-    glBegin(GL_TRIANGLE_FAN);
-    glVertex2f(x, y);
-    int segments = 32;
-    for (int i = 0; i <= segments; i++) {
-        float angle = 2.0f * M_PI * i / segments;
-        glVertex2f(x + radius * cos(angle), y + radius * sin(angle));
-    }
-    glEnd();
+    scene::roundedRect(shapes, x, y, width, height, radius, color);
 }
 
-// --- Simple bitmap font for "drawText" ---
-// Only capital Latin A-Z, 0-9, colon, dot, dash, space
-void getCharPattern(char c, int pattern[7][5]) {
-    // All zero
-    for (int r=0;r<7;r++) for(int col=0;col<5;col++) pattern[r][col]=0;
-    // Characters
-    if (c>='a' && c<='z') c = c-'a'+'A';
-    switch (c) {
-        case '0': {int p[7][5]={{1,1,1,1,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,1,1,1,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case '1': {int p[7][5]={{0,0,1,0,0},{0,1,1,0,0},{0,0,1,0,0},{0,0,1,0,0},{0,0,1,0,0},{0,0,1,0,0},{1,1,1,1,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case '2': {int p[7][5]={{1,1,1,1,1},{0,0,0,0,1},{0,0,0,0,1},{1,1,1,1,1},{1,0,0,0,0},{1,0,0,0,0},{1,1,1,1,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case '3': {int p[7][5]={{1,1,1,1,1},{0,0,0,0,1},{0,0,0,0,1},{1,1,1,1,1},{0,0,0,0,1},{0,0,0,0,1},{1,1,1,1,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case '4': {int p[7][5]={{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,1,1,1,1},{0,0,0,0,1},{0,0,0,0,1},{0,0,0,0,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case '5': {int p[7][5]={{1,1,1,1,1},{1,0,0,0,0},{1,0,0,0,0},{1,1,1,1,1},{0,0,0,0,1},{0,0,0,0,1},{1,1,1,1,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case '6': {int p[7][5]={{1,1,1,1,1},{1,0,0,0,0},{1,0,0,0,0},{1,1,1,1,1},{1,0,0,0,1},{1,0,0,0,1},{1,1,1,1,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case '7': {int p[7][5]={{1,1,1,1,1},{0,0,0,0,1},{0,0,0,0,1},{0,0,0,1,0},{0,0,1,0,0},{0,1,0,0,0},{1,0,0,0,0}}; memcpy(pattern,p,sizeof(p)); break;}
-        case '8': {int p[7][5]={{1,1,1,1,1},{1,0,0,0,1},{1,0,0,0,1},{1,1,1,1,1},{1,0,0,0,1},{1,0,0,0,1},{1,1,1,1,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case '9': {int p[7][5]={{1,1,1,1,1},{1,0,0,0,1},{1,0,0,0,1},{1,1,1,1,1},{0,0,0,0,1},{0,0,0,0,1},{1,1,1,1,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'A': {int p[7][5]={{0,1,1,1,0},{1,0,0,0,1},{1,0,0,0,1},{1,1,1,1,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'B': {int p[7][5]={{1,1,1,1,0},{1,0,0,0,1},{1,0,0,0,1},{1,1,1,1,0},{1,0,0,0,1},{1,0,0,0,1},{1,1,1,1,0}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'C': {int p[7][5]={{0,1,1,1,1},{1,0,0,0,0},{1,0,0,0,0},{1,0,0,0,0},{1,0,0,0,0},{1,0,0,0,0},{0,1,1,1,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'D': {int p[7][5]={{1,1,1,1,0},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,1,1,1,0}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'E': {int p[7][5]={{1,1,1,1,1},{1,0,0,0,0},{1,0,0,0,0},{1,1,1,1,0},{1,0,0,0,0},{1,0,0,0,0},{1,1,1,1,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'F': {int p[7][5]={{1,1,1,1,1},{1,0,0,0,0},{1,0,0,0,0},{1,1,1,1,0},{1,0,0,0,0},{1,0,0,0,0},{1,0,0,0,0}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'G': {int p[7][5]={{0,1,1,1,1},{1,0,0,0,0},{1,0,0,0,0},{1,0,1,1,1},{1,0,0,0,1},{1,0,0,0,1},{0,1,1,1,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'H': {int p[7][5]={{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,1,1,1,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'I': {int p[7][5]={{1,1,1,1,1},{0,0,1,0,0},{0,0,1,0,0},{0,0,1,0,0},{0,0,1,0,0},{0,0,1,0,0},{1,1,1,1,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'J': {int p[7][5]={{1,1,1,1,1},{0,0,0,0,1},{0,0,0,0,1},{0,0,0,0,1},{0,0,0,0,1},{1,0,0,0,1},{0,1,1,1,0}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'K': {int p[7][5]={{1,0,0,0,1},{1,0,0,1,0},{1,0,1,0,0},{1,1,0,0,0},{1,0,1,0,0},{1,0,0,1,0},{1,0,0,0,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'L': {int p[7][5]={{1,0,0,0,0},{1,0,0,0,0},{1,0,0,0,0},{1,0,0,0,0},{1,0,0,0,0},{1,0,0,0,0},{1,1,1,1,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'M': {int p[7][5]={{1,0,0,0,1},{1,1,0,1,1},{1,0,1,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'N': {int p[7][5]={{1,0,0,0,1},{1,1,0,0,1},{1,0,1,0,1},{1,0,0,1,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'O': {int p[7][5]={{0,1,1,1,0},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{0,1,1,1,0}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'P': {int p[7][5]={{1,1,1,1,0},{1,0,0,0,1},{1,0,0,0,1},{1,1,1,1,0},{1,0,0,0,0},{1,0,0,0,0},{1,0,0,0,0}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'Q': {int p[7][5]={{0,1,1,1,0},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,1,0,1},{1,0,0,1,0},{0,1,1,0,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'R': {int p[7][5]={{1,1,1,1,0},{1,0,0,0,1},{1,0,0,0,1},{1,1,1,1,0},{1,0,1,0,0},{1,0,0,1,0},{1,0,0,0,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'S': {int p[7][5]={{0,1,1,1,1},{1,0,0,0,0},{1,0,0,0,0},{0,1,1,1,0},{0,0,0,0,1},{0,0,0,0,1},{1,1,1,1,0}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'T': {int p[7][5]={{1,1,1,1,1},{0,0,1,0,0},{0,0,1,0,0},{0,0,1,0,0},{0,0,1,0,0},{0,0,1,0,0},{0,0,1,0,0}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'U': {int p[7][5]={{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{0,1,1,1,0}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'V': {int p[7][5]={{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{0,1,0,1,0},{0,1,0,1,0},{0,0,1,0,0}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'W': {int p[7][5]={{1,0,0,0,1},{1,0,0,0,1},{1,0,0,0,1},{1,0,1,0,1},{1,0,1,0,1},{1,1,0,1,1},{1,0,0,0,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'X': {int p[7][5]={{1,0,0,0,1},{0,1,0,1,0},{0,0,1,0,0},{0,0,1,0,0},{0,0,1,0,0},{0,1,0,1,0},{1,0,0,0,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'Y': {int p[7][5]={{1,0,0,0,1},{0,1,0,1,0},{0,0,1,0,0},{0,0,1,0,0},{0,0,1,0,0},{0,0,1,0,0},{0,0,1,0,0}}; memcpy(pattern,p,sizeof(p)); break;}
-        case 'Z': {int p[7][5]={{1,1,1,1,1},{0,0,0,0,1},{0,0,0,1,0},{0,0,1,0,0},{0,1,0,0,0},{1,0,0,0,0},{1,1,1,1,1}}; memcpy(pattern,p,sizeof(p)); break;}
-        case ':': {int p[7][5]={{0,0,0,0,0},{0,0,1,0,0},{0,0,0,0,0},{0,0,0,0,0},{0,0,0,0,0},{0,0,1,0,0},{0,0,0,0,0}}; memcpy(pattern,p,sizeof(p)); break;}
-        case '.': {int p[7][5]={{0,0,0,0,0},{0,0,0,0,0},{0,0,0,0,0},{0,0,0,0,0},{0,0,0,0,0},{0,0,1,0,0},{0,0,0,0,0}}; memcpy(pattern,p,sizeof(p)); break;}
-        case '-': {int p[7][5]={{0,0,0,0,0},{0,0,0,0,0},{1,1,1,1,1},{0,0,0,0,0},{0,0,0,0,0},{0,0,0,0,0},{0,0,0,0,0}}; memcpy(pattern,p,sizeof(p)); break;}
-        default: break;
-    }
-}
 
+// One glyph instance per character into the frame's shape batch; the top
+// row of the glyphs sits at y
 void drawText(float x, float y, const char* text, float size, Color color) {
-    glColor4f(color.r, color.g, color.b, color.a);
-    float curX = x;
-    float charWidth = size * 0.7f, charHeight = size;
-    float pixelWidth = charWidth / 5.0f * 1.05f, pixelHeight = charHeight / 7.0f * 1.05f;
-    for (const char* p = text; *p; ++p) {
-        char c = *p;
-        if (c == ' ') { curX += charWidth; continue; }
-        int pattern[7][5]; getCharPattern(c, pattern);
-        for (int row=0; row<7; row++) for (int col=0; col<5; col++)
-            if (pattern[row][col]) {
-                float px = curX + col * (charWidth / 5.0f);
-                float py = y - row * (charHeight / 7.0f);
-                glBegin(GL_QUADS);
-                glVertex2f(px, py);
-                glVertex2f(px + pixelWidth, py);
-                glVertex2f(px + pixelWidth, py + pixelHeight);
-                glVertex2f(px, py + pixelHeight);
-                glEnd();
-            }
-        curX += charWidth + size * 0.1f;
-    }
+    ScopedTimer timer(frameStats, FrameStats::TEXT);
+    scene::text(shapes, x, y, text, size, color);
 }
 
 // --- Menu, Game, About, Pause, Game Over screens (simplified) ---
@@ -279,150 +215,157 @@ void drawAbout() {
     drawText(-0.5f, infoY-0.4f, "CONTROLS:", 0.035f, ACCENT_COLOR);
     drawText(-0.5f, infoY-0.48f, "ARROW KEYS - MOVE SNAKE", 0.03f, TEXT_COLOR);
     drawText(-0.5f, infoY-0.55f, "ESC - PAUSE/MENU", 0.03f, TEXT_COLOR);
+    drawText(-0.5f, infoY-0.62f, "F3 - PERFORMANCE OVERLAY", 0.03f, TEXT_COLOR);
     drawText(-0.25f, -0.6f, "PRESS ESC TO GO BACK", 0.03f, Color{TEXT_COLOR.r, TEXT_COLOR.g, TEXT_COLOR.b, 0.8f});
 }
 
-void drawGameOverScreen() {
+void drawEndScreen(const char* title, float titleX, Color titleColor) {
     float overlayAlpha = gameOverAnimation;
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glColor4f(0.0f, 0.0f, 0.0f, overlayAlpha * 0.7f);
-    glBegin(GL_QUADS);
-    glVertex2f(-1.0f, -1.0f); glVertex2f(1.0f, -1.0f);
-    glVertex2f(1.0f, 1.0f); glVertex2f(-1.0f, 1.0f);
-    glEnd();
+    shapes.rect(0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, overlayAlpha * 0.7f);
     if (overlayAlpha > 0.5f) {
-        float pulseScale = 1.0f + 0.1f * sin(animationTime * 4.0f);
+        // The pulse settles as the fade completes so the finished screen is static
+        float pulseScale = 1.0f + 0.2f * (1.0f - overlayAlpha) * sin(animationTime * 4.0f);
         float gameOverSize = 0.08f * pulseScale;
-        drawText(-0.35f, 0.3f, "GAME OVER", gameOverSize, Color{1.0f, 0.3f, 0.3f, overlayAlpha});
-        char scoreText[64]; snprintf(scoreText, sizeof(scoreText), "FINAL SCORE: %d", score);
+        drawText(titleX, 0.3f, title, gameOverSize, Color{titleColor.r, titleColor.g, titleColor.b, overlayAlpha});
+        char scoreText[64]; snprintf(scoreText, sizeof(scoreText), "FINAL SCORE: %d", sim.score());
         float scoreWidth = strlen(scoreText) * 0.05f * 0.7f;
         drawText(-scoreWidth/2, 0.1f, scoreText, 0.05f, Color{TEXT_COLOR.r, TEXT_COLOR.g, TEXT_COLOR.b, overlayAlpha});
         drawText(-0.25f, -0.1f, "PRESS R TO RESTART", 0.04f, Color{ACCENT_COLOR.r, ACCENT_COLOR.g, ACCENT_COLOR.b, overlayAlpha});
         drawText(-0.2f, -0.2f, "PRESS ESC FOR MENU", 0.04f, Color{TEXT_COLOR.r, TEXT_COLOR.g, TEXT_COLOR.b, overlayAlpha*0.8f});
     }
-    glDisable(GL_BLEND);
+}
+
+void drawGameOverScreen() {
+    drawEndScreen("GAME OVER", -0.35f, Color{1.0f, 0.3f, 0.3f, 1.0f});
+}
+
+void drawBoardCompleteScreen() {
+    drawEndScreen("BOARD COMPLETE", -0.5f, ACCENT_COLOR);
 }
 
 void drawPauseScreen() {
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glColor4f(0.0f, 0.0f, 0.0f, 0.6f);
-    glBegin(GL_QUADS);
-    glVertex2f(-1.0f, -1.0f); glVertex2f(1.0f, -1.0f);
-    glVertex2f(1.0f, 1.0f); glVertex2f(-1.0f, 1.0f);
-    glEnd();
+    shapes.rect(0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.6f);
     drawText(-0.15f, 0.1f, "PAUSED", 0.08f, ACCENT_COLOR);
     drawText(-0.23f, -0.1f, "PRESS ESC TO RESUME", 0.035f, TEXT_COLOR);
-    glDisable(GL_BLEND);
+}
+
+void drawHud() {
+    TRACE_SCOPE("drawHud");
+    HudInfo info = {sim.score(), sim.length(), (difficulty==EASY)?"EASY":((difficulty==MEDIUM)?"MEDIUM":"HARD"),
+                    replayPlayer ? "REPLAY: LEFT RIGHT - SEEK" : (autopilotOn ? "AUTOPILOT: A - TAKE OVER" : "CONTROLS: ARROWS - MOVE  A - AUTO")};
+    scene::hud(shapes, info);
 }
 
 void drawGame() {
-    // Top UI panel
-    drawRoundedRect(-1.0f, 1.0f-TOP_UI_HEIGHT_NDC, 2.0f, TOP_UI_HEIGHT_NDC, 0.02f, Color{UI_COLOR.r, UI_COLOR.g, UI_COLOR.b, 0.9f});
-    float topPanelCenterY = 1.0f-(TOP_UI_HEIGHT_NDC/2.0f), textLineOffset = 0.02f;
-    drawText(-0.95f, topPanelCenterY+textLineOffset, "SCORE", 0.03f, ACCENT_COLOR);
-    char buf[32]; snprintf(buf, sizeof(buf), "%d", score);
-    drawText(-0.95f, topPanelCenterY-textLineOffset, buf, 0.04f, TEXT_COLOR);
-    const char* diffHeading = "DIFFICULTY";
-    float diffHeadingWidth = strlen(diffHeading)*0.03f*0.7f;
-    drawText(-diffHeadingWidth/2, topPanelCenterY+textLineOffset, diffHeading, 0.03f, ACCENT_COLOR);
-    const char* diffValueText = (difficulty==EASY)?"EASY":((difficulty==MEDIUM)?"MEDIUM":"HARD");
-    float diffValueTextWidth = strlen(diffValueText)*0.04f*0.7f;
-    drawText(-diffValueTextWidth/2, topPanelCenterY-textLineOffset, diffValueText, 0.04f, TEXT_COLOR);
-    float studentTextSize=0.025f, studentLineHeight=studentTextSize*1.2f, studentInfoBlockTopY=topPanelCenterY+(studentLineHeight/2.0f);
-    float nameTextWidth = strlen(STUDENT_NAME)*studentTextSize*0.7f;
-    drawText(0.95f-nameTextWidth, studentInfoBlockTopY-(studentTextSize*0.5f), STUDENT_NAME, studentTextSize, TEXT_COLOR);
-    char idText[32]; snprintf(idText, sizeof(idText), "ID: %s", STUDENT_ID);
-    float idTextWidth = strlen(idText)*studentTextSize*0.7f;
-    drawText(0.95f-idTextWidth, studentInfoBlockTopY-studentLineHeight-(studentTextSize*0.5f), idText, studentTextSize, TEXT_COLOR);
-
-    // Bottom UI panel
-    drawRoundedRect(-1.0f, -1.0f, 2.0f, BOTTOM_UI_HEIGHT_NDC, 0.02f, Color{UI_COLOR.r, UI_COLOR.g, UI_COLOR.b, 0.9f});
-    float bottomPanelCenterY = -1.0f+(BOTTOM_UI_HEIGHT_NDC/2.0f);
-    drawText(-0.95f, bottomPanelCenterY+textLineOffset, "CONTROLS: ARROWS - MOVE", 0.03f, ACCENT_COLOR);
-    drawText(-0.95f, bottomPanelCenterY-textLineOffset, "ESC - PAUSE/MENU", 0.03f, ACCENT_COLOR);
-    const char* lengthHeading = "LENGTH";
-    float lengthHeadingWidth = strlen(lengthHeading)*0.03f*0.7f;
-    drawText(0.95f-lengthHeadingWidth, bottomPanelCenterY+textLineOffset, lengthHeading, 0.03f, ACCENT_COLOR);
-    snprintf(buf, sizeof(buf), "%d", snakeLen);
-    float lengthValueTextWidth = strlen(buf)*0.04f*0.7f;
-    drawText(0.95f-lengthValueTextWidth, bottomPanelCenterY-textLineOffset, buf, 0.04f, TEXT_COLOR);
-
-    // Game area border
-    float borderThicknessNDC_X = (float)2/WIDTH*2.0f, borderThicknessNDC_Y=(float)2/HEIGHT*2.0f;
-    drawRoundedRect(GAME_AREA_LEFT_NDC-borderThicknessNDC_X, GAME_AREA_BOTTOM_NDC-borderThicknessNDC_Y,
-        (GAME_AREA_RIGHT_NDC-GAME_AREA_LEFT_NDC)+2*borderThicknessNDC_X, (GAME_AREA_TOP_NDC-GAME_AREA_BOTTOM_NDC)+2*borderThicknessNDC_Y,
-        0.03f, Color{GAME_BORDER_COLOR.r, GAME_BORDER_COLOR.g, GAME_BORDER_COLOR.b, 0.5f});
-
-    // Food
-    float gameAreaWidthNDC = GAME_AREA_RIGHT_NDC-GAME_AREA_LEFT_NDC, gameAreaHeightNDC = GAME_AREA_TOP_NDC-GAME_AREA_BOTTOM_NDC;
-    float cellWidthNDC = gameAreaWidthNDC/gridWidth, cellHeightNDC = gameAreaHeightNDC/gridHeight;
-    float foodX = GAME_AREA_LEFT_NDC+(food.x+0.5f)*cellWidthNDC, foodY = GAME_AREA_BOTTOM_NDC+(food.y+0.5f)*cellHeightNDC;
-    float foodHalfSize = cellWidthNDC*0.45f;
-    glColor4f(FOOD_COLOR.r, FOOD_COLOR.g, FOOD_COLOR.b, 0.3f);
-    glBegin(GL_QUADS);
-    glVertex2f(foodX-foodHalfSize*1.2f, foodY-foodHalfSize*1.2f);
-    glVertex2f(foodX+foodHalfSize*1.2f, foodY-foodHalfSize*1.2f);
-    glVertex2f(foodX+foodHalfSize*1.2f, foodY+foodHalfSize*1.2f);
-    glVertex2f(foodX-foodHalfSize*1.2f, foodY+foodHalfSize*1.2f);
-    glEnd();
-    glColor4f(FOOD_COLOR.r, FOOD_COLOR.g, FOOD_COLOR.b, FOOD_COLOR.a);
-    glBegin(GL_QUADS);
-    glVertex2f(foodX-foodHalfSize, foodY-foodHalfSize);
-    glVertex2f(foodX+foodHalfSize, foodY-foodHalfSize);
-    glVertex2f(foodX+foodHalfSize, foodY+foodHalfSize);
-    glVertex2f(foodX-foodHalfSize, foodY+foodHalfSize);
-    glEnd();
-
-    // Snake
-    for (int i=0;i<snakeLen;i++) {
-        float snakeX = GAME_AREA_LEFT_NDC+(snake[i].x+0.5f)*cellWidthNDC, snakeY = GAME_AREA_BOTTOM_NDC+(snake[i].y+0.5f)*cellHeightNDC;
-        float snakeRadius = cellWidthNDC*0.48f;
-        Color segmentColor = (i==0) ? SNAKE_HEAD_COLOR : SNAKE_BODY_COLOR;
-        if (i==0) drawCircle(snakeX, snakeY, snakeRadius*1.2f, Color{segmentColor.r, segmentColor.g, segmentColor.b, 0.4f});
-        drawCircle(snakeX, snakeY, snakeRadius, segmentColor);
+    HudKey key = {sim.score(), sim.length(), framebufferWidth, framebufferHeight, difficulty, autopilotOn, replayPlayer != nullptr};
+    if (!(key == hudDrawn) || !hudLayer.ready()) {
+        if (hudLayer.begin(framebufferWidth, framebufferHeight)) {
+            drawHud();
+            shapes.flush();
+            hudLayer.end();
+            hudDrawn = key;
+        } else drawHud();
     }
+    shapes.flush();  // the HUD, when there is no layer to hold it
+    hudLayer.present();
+
+    // Food and snake are clipped to the game area, so a segment sliding
+    // across a wrapping edge shows on both sides without spilling over
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(0, scene::boardClipY(framebufferHeight), framebufferWidth, scene::boardClipHeight(framebufferHeight));
+    float headX, headY;
+    scene::segmentPosition(sim, 0, tickAlpha, previousTail, previousLength, headX, headY);
+    BoardView board = camera.view(sim, headX, headY);
+    scene::food(shapes, sim, board);
+    // The snake layer draws every segment, so it only takes snakes no longer
+    // than the cells on screen; past that the culled CPU path is cheaper
+    if (snakeLayer.ready() && (board.whole || sim.length() <= (board.x1 - board.x0) * (board.y1 - board.y0))) {
+        shapes.flush();
+        const float head[4] = {SNAKE_HEAD_COLOR.r, SNAKE_HEAD_COLOR.g, SNAKE_HEAD_COLOR.b, SNAKE_HEAD_COLOR.a};
+        const float body[4] = {SNAKE_BODY_COLOR.r, SNAKE_BODY_COLOR.g, SNAKE_BODY_COLOR.b, SNAKE_BODY_COLOR.a};
+        SnakeLayer::View view = {board.left, board.bottom, board.cellWidth, board.cellHeight,
+                                 board.radius, head, body, tickAlpha, previousTail, previousLength};
+        if (snakeLayer.draw(sim, view)) {
+            glDisable(GL_SCISSOR_TEST);
+            return;
+        }
+    }
+    scene::snake(shapes, sim, board, tickAlpha, previousTail, previousLength, visibleSegments);
+    shapes.flush();
+    glDisable(GL_SCISSOR_TEST);
 }
 
 // --- SNAKE GAME LOGIC ---
-void updateSnake() {
-    for (int i = snakeLen-1; i > 0; --i) snake[i] = snake[i-1];
-    switch (dir) {
-        case UP:    snake[0].y += 1; break;
-        case DOWN:  snake[0].y -= 1; break;
-        case LEFT:  snake[0].x -= 1; break;
-        case RIGHT: snake[0].x += 1; break;
+void saveGameReplay() {
+    TRACE_SCOPE("saveGameReplay");
+    if (!recorder.active() || sim.ticks() == 0) return;
+    const Replay& replay = recorder.finish(sim);
+    std::filesystem::create_directories("replays");
+    std::string path = "replays/snake_" + std::to_string(replay.seed) + "_" + std::to_string(replay.stream) + ".snkr";
+    if (saveReplay(replay, path)) std::cout << "[Saved replay] " << path << std::endl;
+    else std::cerr << "Failed to save replay " << path << "\n";
+}
+
+void checkGameEnd() {
+    if (sim.finished()) {
+        gameState = sim.boardComplete() ? BOARD_COMPLETE : GAME_OVER;
+        gameOverAnimation = 0.0f;
+    } else if (replayPlayer && replayPlayer->atEnd()) {
+        gameState = GAME_OVER, gameOverAnimation = 0.0f;  // recording stopped mid-game
     }
-    if (snake[0].x < 0) snake[0].x = gridWidth - 1;
-    else if (snake[0].x >= gridWidth) snake[0].x = 0;
-    if (snake[0].y < 0) snake[0].y = gridHeight - 1;
-    else if (snake[0].y >= gridHeight) snake[0].y = 0;
-    for (int i = 1; i < snakeLen; ++i)
-        if (snake[0].x == snake[i].x && snake[0].y == snake[i].y)
-            gameState = GAME_OVER, gameOverAnimation = 0.0f;
-    if (snake[0].x == food.x && snake[0].y == food.y) {
-        if (snakeLen < MAX_SNAKE_LENGTH) {
-            snake[snakeLen] = snake[snakeLen-1];
-            ++snakeLen;
+}
+
+void updateSnake() {
+    ScopedTimer timer(frameStats, FrameStats::SIM);
+    TRACE_SCOPE("updateSnake");
+    previousTail = sim.segment(sim.length()-1);
+    previousLength = sim.length();
+    if (replayPlayer) replayPlayer->stepOne();
+    else {
+        Direction turn = sim.direction();
+        double pressedAt;
+        if (autopilotOn) {
+            if (!autopilot) autopilot.reset(new Autopilot(gridWidth, gridHeight));
+            turn = autopilot->decide(sim);
         }
-        score += 10;
-        placeFood();
+        else if (turnQueue.pop(turn, pressedAt)) latency.turnApplied(pressedAt, glfwGetTime());
+        sim.step(turn);
+        recorder.record(sim.direction());
+        if (sim.finished() || recorder.full()) saveGameReplay();
     }
+    checkGameEnd();
 }
 
 void resetGame() {
-    snakeLen = 1;
-    snake[0].x = gridWidth/2;
-    snake[0].y = gridHeight/2;
-    dir = RIGHT;
-    score = 0;
-    placeFood();
+    snakeLayer.invalidate();
+    turnQueue.clear();
+    tickAccumulator = 0.0;
+    previousLength = 0;
+    if (replayPlayer) { replayPlayer->restart(); return; }
+    uint64_t stream = gamesStarted++;
+    sim.reset(sessionSeed, stream);
+    recorder.begin(gridWidth, gridHeight, sessionSeed, stream, (int)(getUpdateInterval() * 1000.0 + 0.5));
 }
 
 // --- Input ---
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
     if (action != GLFW_PRESS && action != GLFW_REPEAT) return;
+    redrawRequested = true;
+    double pressTime = glfwGetTime();
+    bool arrow = key == GLFW_KEY_UP || key == GLFW_KEY_DOWN || key == GLFW_KEY_LEFT || key == GLFW_KEY_RIGHT;
+    if (!(arrow && gameState == PLAYING && !replayPlayer)) latency.keyPressed(pressTime);
+    if (key == GLFW_KEY_F3) {
+        if (action == GLFW_PRESS) perfOverlay = !perfOverlay;
+        return;
+    }
+    if (key == GLFW_KEY_EQUAL || key == GLFW_KEY_KP_ADD) {
+        if (action == GLFW_PRESS) camera.zoom(2.0f);
+        return;
+    }
+    if (key == GLFW_KEY_MINUS || key == GLFW_KEY_KP_SUBTRACT) {
+        if (action == GLFW_PRESS) camera.zoom(0.5f);
+        return;
+    }
     switch (gameState) {
         case MENU:
             if (key == GLFW_KEY_UP) selectedMenuItem = (selectedMenuItem + 2) % 3;
@@ -438,6 +381,7 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
             else if (key == GLFW_KEY_DOWN) selectedDifficulty = (selectedDifficulty + 1) % 3;
             else if (key == GLFW_KEY_ENTER) {
                 difficulty = (Difficulty)selectedDifficulty;
+                replayPlayer.reset();
                 resetGame();
                 gameState = PLAYING;
             } else if (key == GLFW_KEY_ESCAPE) gameState = MENU;
@@ -446,26 +390,55 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
             if (key == GLFW_KEY_ESCAPE) gameState = MENU;
             break;
         case PLAYING:
-            if (key == GLFW_KEY_UP && dir != DOWN) dir = UP;
-            else if (key == GLFW_KEY_DOWN && dir != UP) dir = DOWN;
-            else if (key == GLFW_KEY_LEFT && dir != RIGHT) dir = LEFT;
-            else if (key == GLFW_KEY_RIGHT && dir != LEFT) dir = RIGHT;
+            if (replayPlayer) {
+                if (key == GLFW_KEY_RIGHT) replayPlayer->seek(replayPlayer->tick() + REPLAY_SEEK_TICKS), previousLength = 0;
+                else if (key == GLFW_KEY_LEFT) replayPlayer->seek(replayPlayer->tick() - REPLAY_SEEK_TICKS), previousLength = 0;
+                else if (key == GLFW_KEY_ESCAPE) gameState = PAUSED;
+                checkGameEnd();
+                break;
+            }
+            if (key == GLFW_KEY_UP) turnQueue.push(UP, pressTime, sim.direction());
+            else if (key == GLFW_KEY_DOWN) turnQueue.push(DOWN, pressTime, sim.direction());
+            else if (key == GLFW_KEY_LEFT) turnQueue.push(LEFT, pressTime, sim.direction());
+            else if (key == GLFW_KEY_RIGHT) turnQueue.push(RIGHT, pressTime, sim.direction());
+            else if (key == GLFW_KEY_A) { autopilotOn = !autopilotOn; turnQueue.clear(); }
             else if (key == GLFW_KEY_ESCAPE) gameState = PAUSED;
             break;
         case PAUSED:
             if (key == GLFW_KEY_ESCAPE) gameState = PLAYING;
             break;
         case GAME_OVER:
+        case BOARD_COMPLETE:
             if (key == GLFW_KEY_R) { resetGame(); gameState = PLAYING; }
             else if (key == GLFW_KEY_ESCAPE) gameState = MENU;
             break;
     }
 }
 
+// Phase times are means over the last FrameStats::WINDOW frames; calls and
+// vertices are those of the previous frame, since this one is still drawing
+void drawPerfOverlay() {
+    drawRoundedRect(-0.98f, 0.62f, 0.86f, 0.34f, 0.02f, Color{0.0f, 0.0f, 0.0f, 0.6f});
+    char line[96];
+    snprintf(line, sizeof(line), "FRAME %.2f MS", frameStats.lastFrameMs());
+    drawText(-0.95f, 0.9f, line, 0.03f, ACCENT_COLOR);
+    snprintf(line, sizeof(line), "P50 %.2f  P99 %.2f", frameStats.frameMsPercentile(0.5), frameStats.frameMsPercentile(0.99));
+    drawText(-0.95f, 0.84f, line, 0.03f, TEXT_COLOR);
+    snprintf(line, sizeof(line), "SIM %.3f  UPDATE %.3f", frameStats.phaseMs(FrameStats::SIM), frameStats.phaseMs(FrameStats::UPDATE));
+    drawText(-0.95f, 0.78f, line, 0.03f, TEXT_COLOR);
+    snprintf(line, sizeof(line), "DRAW %.3f  TEXT %.3f", frameStats.phaseMs(FrameStats::DRAW), frameStats.phaseMs(FrameStats::TEXT));
+    drawText(-0.95f, 0.72f, line, 0.03f, TEXT_COLOR);
+    snprintf(line, sizeof(line), "SWAP %.3f", frameStats.phaseMs(FrameStats::SWAP));
+    drawText(-0.95f, 0.66f, line, 0.03f, TEXT_COLOR);
+    snprintf(line, sizeof(line), "CALLS %lld  VERTS %lld", frameStats.lastDrawCalls(), frameStats.lastVertices());
+    drawText(-0.5f, 0.66f, line, 0.03f, TEXT_COLOR);
+}
+
 void draw() {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    drawGradientBackground();
+    bool inGame = gameState == PLAYING || gameState == PAUSED || gameState == GAME_OVER || gameState == BOARD_COMPLETE;
+    if (!inGame) drawGradientBackground();  // game screens get it with the HUD layer
     switch (gameState) {
         case MENU: drawMenu(); break;
         case DIFFICULTY_SELECT: drawDifficultySelect(); break;
@@ -473,52 +446,334 @@ void draw() {
         case PLAYING: drawGame(); break;
         case PAUSED: drawGame(); drawPauseScreen(); break;
         case GAME_OVER: drawGame(); drawGameOverScreen(); break;
+        case BOARD_COMPLETE: drawGame(); drawBoardCompleteScreen(); break;
     }
+    if (perfOverlay) drawPerfOverlay();
+    shapes.flush();
     glDisable(GL_BLEND);
 }
 
+void writeLatencyLog() {
+    if (latencyLogPath.empty()) return;
+    latency.printSummary();
+    char settings[160];
+    snprintf(settings, sizeof(settings), "vsync %s, fps cap %g, poll %s, tick %.0f ms", vsyncEnabled ? "on" : "off",
+             fpsCap, pollBeforeTick ? "before-tick" : "after-swap", getUpdateInterval() * 1000.0);
+    if (latency.write(latencyLogPath, settings)) std::cout << "[Saved latency] " << latencyLogPath << std::endl;
+    else std::cerr << "Failed to write " << latencyLogPath << "\n";
+}
+
+void writeTrace() {
+    if (tracePath.empty()) return;
+    if (trace::write(tracePath.c_str())) std::cout << "[Saved trace] " << tracePath << std::endl;
+    else std::cerr << "Failed to write " << tracePath << " (tracing needs a build with -DENABLE_TRACE=ON)\n";
+}
+
+// --- Offscreen rendering ---
+// --offscreen draws every screen once into a framebuffer object at --size
+// WxH with no visible window and prints a checksum per screen. --dump DIR
+// also writes the frames as PPM, --golden FILE compares the checksums with
+// a saved run (exit status 1 on a mismatch) and --bench N times N frames
+// of each screen. The board is the autopilot's after a fixed number of
+// ticks from --seed (default 1), so the same renderer and driver always
+// produce the same pixels.
+struct OffscreenOptions {
+    bool enabled = false;
+    int width = WIDTH, height = HEIGHT;
+    std::string dumpDir, goldenPath;
+    int benchFrames = 0;
+};
+OffscreenOptions offscreen;
+const int OFFSCREEN_WARMUP_TICKS = 150;
+
+struct OffscreenScreen { GameState state; const char* name; };
+const OffscreenScreen OFFSCREEN_SCREENS[] = {
+    {MENU, "menu"}, {DIFFICULTY_SELECT, "difficulty"}, {ABOUT, "about"}, {PLAYING, "playing"},
+    {PAUSED, "paused"}, {GAME_OVER, "game_over"}, {BOARD_COMPLETE, "board_complete"},
+};
+
+// Offscreen runs prefer Mesa's software rasterizer through OSMesa on GLFW's
+// null platform, which needs no display; without OSMesa they fall back to a
+// hidden window on the native platform. Either way a 3.3 core context is
+// tried before a compatibility one.
+GLFWwindow* openWindow(bool hidden, bool& coreProfile) {
+    for (int attempt = hidden ? 0 : 1; attempt < 2; ++attempt) {
+        bool osmesa = attempt == 0;
+        glfwInitHint(GLFW_PLATFORM, osmesa ? GLFW_PLATFORM_NULL : GLFW_ANY_PLATFORM);
+        if (!glfwInit()) continue;
+        for (int core = legacyGl ? 0 : 1; core >= 0; --core) {
+            glfwDefaultWindowHints();
+            if (hidden) glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            if (osmesa) glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+            if (core) {
+                glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+                glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+                glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+                glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+            }
+            GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "Snake Game Toha(240113)", NULL, NULL);
+            if (window) { coreProfile = core; return window; }
+        }
+        glfwTerminate();
+        if (osmesa) std::cerr << "OSMesa unavailable, rendering offscreen through a hidden window\n";
+    }
+    return NULL;
+}
+
+// One frame of the current state into `target`, read back bottom row first
+void renderOffscreenFrame(OffscreenLayer& target, std::vector<uint8_t>* pixels) {
+    target.begin(offscreen.width, offscreen.height);
+    draw();
+    if (pixels) glReadPixels(0, 0, offscreen.width, offscreen.height, GL_RGBA, GL_UNSIGNED_BYTE, pixels->data());
+    target.end();
+}
+
+int runOffscreen() {
+    int w = offscreen.width, h = offscreen.height;
+    glViewport(0, 0, w, h);
+    framebufferWidth = w, framebufferHeight = h;
+    shapes.setViewport(w, h);
+
+    // The board every game screen is drawn over
+    gamesStarted = 0;
+    gameState = PLAYING;
+    resetGame();
+    autopilotOn = true;
+    for (int i = 0; i < OFFSCREEN_WARMUP_TICKS && gameState == PLAYING; ++i) updateSnake();
+    tickAlpha = 0.5f;
+    gameOverAnimation = 1.0f;
+    animationTime = 1.0f;
+
+    std::vector<std::pair<std::string, std::string>> golden;
+    if (!offscreen.goldenPath.empty()) {
+        std::ifstream f(offscreen.goldenPath);
+        if (!f) { std::cerr << "Failed to read " << offscreen.goldenPath << "\n"; return -1; }
+        std::string name, sum;
+        while (f >> name >> sum) golden.push_back({name, sum});
+    }
+    if (!offscreen.dumpDir.empty()) std::filesystem::create_directories(offscreen.dumpDir);
+
+    OffscreenLayer target;
+    std::vector<uint8_t> pixels(4 * (size_t)w * h);
+    int mismatches = 0;
+    for (const OffscreenScreen& screen : OFFSCREEN_SCREENS) {
+        gameState = screen.state;
+        renderOffscreenFrame(target, &pixels);
+        if (!target.ready()) { std::cerr << "Framebuffer objects unavailable, cannot render offscreen\n"; return -1; }
+        char sum[17];
+        snprintf(sum, sizeof(sum), "%016llx", (unsigned long long)frameChecksum(w, h, pixels.data()));
+        printf("%-16s %s", screen.name, sum);
+        for (const auto& g : golden)
+            if (g.first == screen.name && g.second != sum) { printf("  MISMATCH (golden %s)", g.second.c_str()); ++mismatches; }
+        printf("\n");
+        if (!offscreen.dumpDir.empty()) {
+            std::string path = offscreen.dumpDir + "/" + screen.name + ".ppm";
+            if (!writePpm(path, w, h, pixels.data())) std::cerr << "Failed to write " << path << "\n";
+        }
+        if (offscreen.benchFrames > 0) {
+            glFinish();
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < offscreen.benchFrames; ++i) {
+                renderOffscreenFrame(target, NULL);
+                glFinish();
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            printf("%-16s %.3f ms/frame over %d frames at %dx%d\n", "", ms / offscreen.benchFrames, offscreen.benchFrames, w, h);
+        }
+    }
+    target.release();
+    return mismatches ? 1 : 0;
+}
+
 // --- Main ---
-int main() {
-    srand((unsigned int)time(NULL));
-    if (!glfwInit()) { std::cerr << "Failed to initialize GLFW\n"; return -1; }
-    GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "Snake Game Toha(240113)", NULL, NULL);
-    if (!window) { std::cerr << "Failed to create GLFW window\n"; glfwTerminate(); return -1; }
+// --config FILE reads more options from FILE, one per line as they would be
+// given here but without the leading dashes ("grid 200x120", "no-vsync"),
+// with '#' starting a comment. They take the place of --config, so flags
+// after it override the file.
+bool expandConfig(int argc, char** argv, std::vector<std::string>& args) {
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--config") || i + 1 >= argc) { args.push_back(argv[i]); continue; }
+        std::ifstream f(argv[++i]);
+        if (!f) { std::cerr << "Failed to read config " << argv[i] << "\n"; return false; }
+        std::string line;
+        while (std::getline(f, line)) {
+            std::istringstream words(line.substr(0, line.find('#')));
+            std::string word;
+            if (!(words >> word)) continue;
+            args.push_back("--" + word);
+            while (words >> word) args.push_back(word);
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> args;
+    if (!expandConfig(argc, argv, args)) return -1;
+    // Everything below reads the expanded list
+    argc = (int)args.size() + 1;
+    std::vector<char*> argPointers(1, argv[0]);
+    for (std::string& a : args) argPointers.push_back(&a[0]);
+    argv = argPointers.data();
+
+    const char* replayPath = NULL;
+    bool seedGiven = false;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--grid") && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &gridWidth, &gridHeight) != 2 || gridWidth < 2 || gridHeight < 2 ||
+                gridWidth > MAX_GRID_SIDE || gridHeight > MAX_GRID_SIDE) {
+                std::cerr << "--grid wants WxH, 2 to " << MAX_GRID_SIDE << " a side\n"; return -1;
+            }
+        }
+        else if (!strcmp(argv[i], "--zoom") && i + 1 < argc) {
+            camera.cellPixels = (float)atof(argv[++i]);
+            if (!(camera.cellPixels >= MIN_CELL_PIXELS && camera.cellPixels <= MAX_CELL_PIXELS)) {
+                std::cerr << "--zoom wants a cell size of " << MIN_CELL_PIXELS << " to " << MAX_CELL_PIXELS << " pixels\n"; return -1;
+            }
+        }
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc) sessionSeed = strtoull(argv[++i], NULL, 10), seedGiven = true;
+        else if (!strcmp(argv[i], "--replay") && i + 1 < argc) replayPath = argv[++i];
+        else if (!strcmp(argv[i], "--fps") && i + 1 < argc) fpsCap = std::max(0.0, atof(argv[++i]));
+        else if (!strcmp(argv[i], "--no-vsync")) vsyncEnabled = false;
+        else if (!strcmp(argv[i], "--latency-log") && i + 1 < argc) latencyLogPath = argv[++i];
+        else if (!strcmp(argv[i], "--poll-before-tick")) pollBeforeTick = true;
+        else if (!strcmp(argv[i], "--trace") && i + 1 < argc) tracePath = argv[++i];
+        else if (!strcmp(argv[i], "--legacy-gl")) legacyGl = true;
+        else if (!strcmp(argv[i], "--offscreen")) offscreen.enabled = true;
+        else if (!strcmp(argv[i], "--size") && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &offscreen.width, &offscreen.height) != 2 || offscreen.width <= 0 || offscreen.height <= 0) {
+                std::cerr << "--size wants WxH\n"; return -1;
+            }
+        }
+        else if (!strcmp(argv[i], "--dump") && i + 1 < argc) offscreen.dumpDir = argv[++i];
+        else if (!strcmp(argv[i], "--golden") && i + 1 < argc) offscreen.goldenPath = argv[++i];
+        else if (!strcmp(argv[i], "--bench") && i + 1 < argc) offscreen.benchFrames = atoi(argv[++i]);
+    }
+    if (!seedGiven) sessionSeed = offscreen.enabled ? 1 : (uint64_t)time(NULL);
+    if (replayPath) {
+        if (!loadReplay(replayPath, loadedReplay)) { std::cerr << "Failed to load replay " << replayPath << "\n"; return -1; }
+        // The replay's board wins over --grid
+        gridWidth = loadedReplay.width, gridHeight = loadedReplay.height;
+    }
+    if (gridWidth != sim.width() || gridHeight != sim.height()) sim = SnakeSim(gridWidth, gridHeight);
+    if (replayPath) {
+        replayPlayer.reset(new ReplayPlayer(loadedReplay, sim));
+        gameState = PLAYING;
+    }
+    bool coreProfile = false;
+    GLFWwindow* window = openWindow(offscreen.enabled, coreProfile);
+    if (!window) { std::cerr << "Failed to create GLFW window\n"; return -1; }
     glfwMakeContextCurrent(window);
+    glfwSwapInterval(vsyncEnabled ? 1 : 0);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
     glfwSetKeyCallback(window, key_callback);
+    glfwSetScrollCallback(window, scroll_callback);
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
         std::cerr << "Failed to initialize GLAD\n"; return -1;
     }
-    glMatrixMode(GL_PROJECTION); glLoadIdentity();
-    glOrtho(-1.0, 1.0, -1.0, 1.0, -1.0, 1.0);
-    glMatrixMode(GL_MODELVIEW); glLoadIdentity();
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    shapes.setViewport(framebufferWidth, framebufferHeight);
+    shapes.setGlyphs(&FONT.glyphs[0].rows[0]);
+    if (!legacyGl && shapes.init()) snakeLayer.init(gridWidth, gridHeight);
+    if (coreProfile && !(shapes.instanced() && snakeLayer.ready())) {
+        std::cerr << "Shader renderer failed on a core context, try --legacy-gl\n";
+        glfwTerminate();
+        return -1;
+    }
+    if (!shapes.instanced()) {
+        std::cerr << "Shaders unavailable, drawing in immediate mode\n";
+        glMatrixMode(GL_PROJECTION); glLoadIdentity();
+        glOrtho(-1.0, 1.0, -1.0, 1.0, -1.0, 1.0);
+        glMatrixMode(GL_MODELVIEW); glLoadIdentity();
+    }
+    if (offscreen.enabled) {
+        int status = runOffscreen();
+        hudLayer.release();
+        glfwTerminate();
+        return status;
+    }
 
     resetGame();
-    double lastUpdateTime = glfwGetTime();
     double lastAnimationTime = glfwGetTime();
+    double lastFrameTime = -1.0;
+    bool wasPlaying = false;
 
+    trace::setThreadName("main");
     while (!glfwWindowShouldClose(window)) {
+        TRACE_SCOPE("loop");
+        // Optionally pick up input that arrived during the swap or the
+        // sleep right before this iteration's tick, instead of next time round
+        if (pollBeforeTick) glfwPollEvents();
         double currentTime = glfwGetTime();
-        double deltaTime = currentTime - lastUpdateTime;
         double animationDeltaTime = currentTime - lastAnimationTime;
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        animationTime = currentTime;
-        if (gameState == PLAYING && deltaTime >= getUpdateInterval()) {
-            updateSnake();
-            lastUpdateTime = currentTime;
+        double interval;
+        bool animating;
+        {  // sim ticks inside this block are timed separately
+            ScopedTimer timer(frameStats, FrameStats::UPDATE);
+            TRACE_SCOPE("update");
+            // Time spent outside PLAYING (menus, pause) never turns into ticks
+            interval = getUpdateInterval();
+            if (gameState == PLAYING) {
+                if (wasPlaying) tickAccumulator += animationDeltaTime;
+                int steps = 0;
+                while (tickAccumulator >= interval && gameState == PLAYING) {
+                    if (++steps > MAX_TICKS_PER_FRAME) { tickAccumulator = 0.0; break; }
+                    updateSnake();
+                    tickAccumulator -= interval;
+                }
+            }
+            wasPlaying = (gameState == PLAYING);
+            tickAlpha = (gameState == PLAYING || gameState == PAUSED) ? (float)std::min(1.0, tickAccumulator / interval) : 1.0f;
+            bool gameEnded = (gameState == GAME_OVER || gameState == BOARD_COMPLETE);
+            if (gameEnded && gameOverAnimation < 1.0f) {
+                gameOverAnimation += 0.5f * animationDeltaTime;
+                if (gameOverAnimation > 1.0f) gameOverAnimation = 1.0f;
+                redrawRequested = true;  // one more frame once the fade reaches 1
+            } else if (!gameEnded) gameOverAnimation = 0.0f;
+            lastAnimationTime = currentTime;
+
+            // The menu title glows, the snake glides between cells and the end
+            // screens fade in; everything else only changes on input
+            animating = gameState == MENU || gameState == PLAYING || (gameEnded && gameOverAnimation < 1.0f) || perfOverlay;
+        }
+        double frameInterval = fpsCap > 0.0 ? 1.0 / fpsCap : 0.0;
+        if ((redrawRequested || animating) && currentTime - lastFrameTime >= frameInterval) {
+            animationTime = currentTime;
+            {
+                ScopedTimer timer(frameStats, FrameStats::DRAW);
+                TRACE_SCOPE("draw");
+                glClear(GL_COLOR_BUFFER_BIT);
+                draw();
+            }
+            {
+                ScopedTimer timer(frameStats, FrameStats::SWAP);
+                TRACE_SCOPE("swapBuffers");
+                glfwSwapBuffers(window);
+            }
+            frameStats.endFrame();
+            latency.frameSwapped(glfwGetTime());
+            lastFrameTime = currentTime;
+            redrawRequested = false;
         }
-        if (gameState == GAME_OVER && gameOverAnimation < 1.0f) {
-            gameOverAnimation += 0.5f * animationDeltaTime;
-            if (gameOverAnimation > 1.0f) gameOverAnimation = 1.0f;
-        } else if (gameState != GAME_OVER) gameOverAnimation = 0.0f;
-        lastAnimationTime = currentTime;
-
-        draw();
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        // Sleep until the next tick or frame is due, or until input arrives
+        double wakeTime = -1.0;
+        if (gameState == PLAYING) wakeTime = currentTime + (interval - tickAccumulator);
+        if (animating || redrawRequested) {
+            double nextFrame = lastFrameTime + frameInterval;
+            wakeTime = wakeTime < 0.0 ? nextFrame : std::min(wakeTime, nextFrame);
+        }
+        TRACE_SCOPE("wait");
+        double wait = wakeTime - glfwGetTime();
+        if (wakeTime < 0.0) glfwWaitEvents();
+        else if (wait > 0.0) glfwWaitEventsTimeout(wait);
+        else glfwPollEvents();
     }
+    if (gameState == PLAYING || gameState == PAUSED) saveGameReplay();
+    writeLatencyLog();
+    writeTrace();
+    hudLayer.release();
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "offscreen_layer.h"
+
+#include <iostream>
+
+void OffscreenLayer::release() {
+    if (fbo) glDeleteFramebuffers(1, &fbo);
+    if (color) glDeleteRenderbuffers(1, &color);
+    fbo = color = 0;
+    layerW = layerH = 0;
+}
+
+bool OffscreenLayer::begin(int width, int height) {
+    if (!GLAD_GL_VERSION_3_0 || width <= 0 || height <= 0) return false;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &outer);
+    if (!fbo || width != layerW || height != layerH) {
+        release();
+        glGenRenderbuffers(1, &color);
+        glBindRenderbuffer(GL_RENDERBUFFER, color);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Offscreen layer incomplete, drawing without it\n";
+            glBindFramebuffer(GL_FRAMEBUFFER, outer);
+            release();
+            return false;
+        }
+        layerW = width, layerH = height;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glClear(GL_COLOR_BUFFER_BIT);
+    return true;
+}
+
+void OffscreenLayer::end() {
+    glBindFramebuffer(GL_FRAMEBUFFER, outer);
+}
+
+void OffscreenLayer::present() const {
+    if (!fbo) return;
+    GLint target;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glBlitFramebuffer(0, 0, layerW, layerH, 0, 0, layerW, layerH, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, target);
+}
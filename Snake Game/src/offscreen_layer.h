@@ -0,0 +1,31 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// An offscreen colour buffer the size of the window. Something expensive
+// but rarely changing is drawn into it once, then copied to the screen each
+// frame with a single blit. Layers nest: end() returns to whichever
+// framebuffer was bound at begin() and present() blits into the one bound
+// for drawing, so the whole frame can itself be rendered offscreen. GL
+// objects are not freed on destruction; call release() while the context
+// is still current.
+class OffscreenLayer {
+public:
+    // Redirects drawing into the layer, (re)allocating it at width x height
+    // and clearing it. Returns false, with drawing left on the screen, when
+    // framebuffer objects are unavailable.
+    bool begin(int width, int height);
+    // Back to the framebuffer that was bound before begin()
+    void end();
+    // Copies the layer over the whole framebuffer bound for drawing
+    void present() const;
+
+    bool ready() const { return fbo != 0; }
+    // Deletes the framebuffer and its colour buffer
+    void release();
+
+private:
+    GLuint fbo = 0, color = 0;
+    int layerW = 0, layerH = 0;
+    GLint outer = 0;
+};
@@ -0,0 +1,76 @@
+#include "parallel_runner.h"
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Episodes take milliseconds, so a mutex per deque is cheap next to the work
+// and there is no contention unless someone is stealing.
+struct WorkQueue {
+    std::mutex lock;
+    std::deque<int> items;
+
+    bool popFront(int& out) {
+        std::lock_guard<std::mutex> g(lock);
+        if (items.empty()) return false;
+        out = items.front();
+        items.pop_front();
+        return true;
+    }
+    bool stealBack(int& out) {
+        std::lock_guard<std::mutex> g(lock);
+        if (items.empty()) return false;
+        out = items.back();
+        items.pop_back();
+        return true;
+    }
+};
+
+}  // namespace
+
+RunReport runEpisodes(int count, int threads, const std::function<EpisodeResult(int)>& episode) {
+    if (threads < 1) threads = 1;
+    RunReport report;
+    report.workers.resize(threads);
+    report.episodes.resize(count);
+
+    // Contiguous blocks per worker; stealing evens out whatever this gets wrong
+    std::vector<WorkQueue> queues(threads);
+    for (int t = 0; t < threads; ++t)
+        for (int i = (int)((long long)count * t / threads); i < (long long)count * (t + 1) / threads; ++i)
+            queues[t].items.push_back(i);
+
+    auto worker = [&](int self) {
+        WorkerStats& stats = report.workers[self];
+        int next;
+        for (;;) {
+            bool found = queues[self].popFront(next);
+            // Nothing new is ever queued, so a full sweep with no victim means we are done
+            for (int k = 1; !found && k < threads; ++k)
+                if (queues[(self + k) % threads].stealBack(next)) found = true, ++stats.steals;
+            if (!found) break;
+
+            auto start = Clock::now();
+            EpisodeResult r = episode(next);
+            stats.busySeconds += std::chrono::duration<double>(Clock::now() - start).count();
+            stats.steps += r.steps;
+            ++stats.episodes;
+            report.episodes[next] = r;
+        }
+    };
+
+    auto start = Clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (auto& th : pool) th.join();
+    report.wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (const auto& w : report.workers) report.totalSteps += w.steps;
+    return report;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+// Runs many independent episodes across a pool of threads. Each worker owns a
+// deque of episode indices: it pops from the front of its own and, once that
+// is empty, steals from the back of another worker's. Episode lengths vary a
+// lot, so this keeps every core busy where a static split would not.
+
+struct EpisodeResult {
+    long long steps = 0;
+    int score = 0;
+    bool boardComplete = false;
+    bool finished = false;  // false when the episode was cut off at a step cap
+};
+
+struct WorkerStats {
+    long long episodes = 0;
+    long long steps = 0;
+    long long steals = 0;
+    double busySeconds = 0.0;
+};
+
+struct RunReport {
+    double wallSeconds = 0.0;
+    long long totalSteps = 0;
+    std::vector<WorkerStats> workers;
+    std::vector<EpisodeResult> episodes;  // indexed by episode number
+};
+
+// Calls episode(i) once for every i in [0, count) on `threads` workers.
+// episode() must be safe to call concurrently for different i.
+RunReport runEpisodes(int count, int threads, const std::function<EpisodeResult(int)>& episode);
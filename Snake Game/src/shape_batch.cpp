@@ -0,0 +1,271 @@
+#include "shape_batch.h"
+
+#include <cstring>
+
+#include "arc_table.h"
+#include "frame_stats.h"
+#include "gl_program.h"
+
+static const char* SHAPE_VERTEX_SHADER = R"(#version 330 core
+layout(location = 0) in vec2 corner;
+layout(location = 1) in vec4 rect;
+layout(location = 2) in float param;
+layout(location = 3) in vec4 color;
+layout(location = 4) in vec4 color2;
+layout(location = 5) in float shape;
+out vec2 local;
+out vec4 fillColor;
+flat out vec2 halfSize;
+flat out float fillParam;
+flat out int fillShape;
+void main() {
+    local = corner;
+    fillShape = int(shape);
+    fillColor = (fillShape == 4 && corner.y < 0.0) ? color2 : color;
+    fillParam = param;
+    halfSize = rect.zw;
+    gl_Position = vec4(rect.xy + corner * rect.zw, 0.0, 1.0);
+}
+)";
+
+// Shapes: 0 circle, 1 rectangle, 2 rounded rectangle, 3 glyph, 4 gradient.
+// The font texture holds the 5x7 glyphs side by side, top row first.
+static const char* SHAPE_FRAGMENT_SHADER = R"(#version 330 core
+in vec2 local;
+in vec4 fillColor;
+flat in vec2 halfSize;
+flat in float fillParam;
+flat in int fillShape;
+uniform sampler2D glyphs;
+out vec4 fragColor;
+void main() {
+    vec2 pixel = fwidth(local) * halfSize;  // one pixel in NDC along each axis
+    float coverage = 1.0;
+    if (fillShape == 0) {
+        float d = (length(local) - 1.0) * halfSize.x;
+        coverage = clamp(0.5 - d / max(pixel.x, pixel.y), 0.0, 1.0);
+    } else if (fillShape == 2) {
+        vec2 q = abs(local * halfSize) - (halfSize - vec2(fillParam));
+        float d = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - fillParam;
+        coverage = clamp(0.5 - d / max(pixel.x, pixel.y), 0.0, 1.0);
+    } else if (fillShape == 3) {
+        vec2 uv = local * 0.5 + 0.5;
+        ivec2 texel = ivec2(int(fillParam) * 5 + min(int(uv.x * 5.0), 4), min(int((1.0 - uv.y) * 7.0), 6));
+        coverage = texelFetch(glyphs, texel, 0).r;
+    }
+    if (coverage <= 0.0) discard;
+    fragColor = vec4(fillColor.rgb, fillColor.a * coverage);
+}
+)";
+
+static const size_t STREAM_BYTES = 1 << 20;
+static const int GLYPH_COUNT = 128, GLYPH_W = 5, GLYPH_H = 7;
+
+bool ShapeBatch::init() {
+    if (!GLAD_GL_VERSION_3_3) return false;
+    program = buildProgram(SHAPE_VERTEX_SHADER, SHAPE_FRAGMENT_SHADER, "Shape");
+    if (!program) return false;
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "glyphs"), 0);
+    glUseProgram(0);
+
+    static const float QUAD[8] = {-1, -1, 1, -1, -1, 1, 1, 1};
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &quadVbo);
+    glGenBuffers(1, &instanceVbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(QUAD), QUAD, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    for (GLuint attr = 1; attr <= 5; ++attr) {
+        glEnableVertexAttribArray(attr);
+        glVertexAttribDivisor(attr, 1);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    streamCapacity = STREAM_BYTES;
+    glBufferData(GL_ARRAY_BUFFER, streamCapacity, NULL, GL_STREAM_DRAW);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glGenTextures(1, &glyphTexture);
+    if (glyphRows) uploadGlyphs();
+    return true;
+}
+
+void ShapeBatch::setGlyphs(const uint8_t* rows) {
+    glyphRows = rows;
+    if (program) uploadGlyphs();
+}
+
+void ShapeBatch::uploadGlyphs() {
+    static uint8_t texels[GLYPH_H][GLYPH_COUNT * GLYPH_W];
+    for (int g = 0; g < GLYPH_COUNT; ++g)
+        for (int row = 0; row < GLYPH_H; ++row)
+            for (int col = 0; col < GLYPH_W; ++col)
+                texels[row][g * GLYPH_W + col] = (glyphRows[g * GLYPH_H + row] >> (4 - col) & 1) ? 255 : 0;
+    glBindTexture(GL_TEXTURE_2D, glyphTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, GLYPH_COUNT * GLYPH_W, GLYPH_H, 0, GL_RED, GL_UNSIGNED_BYTE, texels);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+static uint8_t toByte(float c) {
+    return (uint8_t)(c <= 0.0f ? 0 : (c >= 1.0f ? 255 : c * 255.0f + 0.5f));
+}
+
+ShapeBatch::Instance& ShapeBatch::add(float x, float y, float halfW, float halfH, float r, float g, float b, float a, Shape shape) {
+    Instance s;
+    s.x = x; s.y = y; s.halfW = halfW; s.halfH = halfH;
+    s.param = 0.0f;
+    s.color[0] = toByte(r); s.color[1] = toByte(g); s.color[2] = toByte(b); s.color[3] = toByte(a);
+    memcpy(s.color2, s.color, 4);
+    s.shape = shape;
+    s.pad[0] = s.pad[1] = s.pad[2] = 0;
+    shapes.push_back(s);
+    return shapes.back();
+}
+
+void ShapeBatch::circle(float x, float y, float radius, float r, float g, float b, float a) {
+    add(x, y, radius, radius, r, g, b, a, CIRCLE);
+}
+
+void ShapeBatch::rect(float x, float y, float halfW, float halfH, float r, float g, float b, float a) {
+    add(x, y, halfW, halfH, r, g, b, a, RECT);
+}
+
+void ShapeBatch::roundedRect(float x, float y, float halfW, float halfH, float radius, float r, float g, float b, float a) {
+    add(x, y, halfW, halfH, r, g, b, a, ROUNDED_RECT).param = radius;
+}
+
+void ShapeBatch::gradient(float x, float y, float halfW, float halfH, const float* top, const float* bottom) {
+    Instance& s = add(x, y, halfW, halfH, top[0], top[1], top[2], top[3], GRADIENT);
+    for (int i = 0; i < 4; ++i) s.color2[i] = toByte(bottom[i]);
+}
+
+void ShapeBatch::glyph(float x, float y, float halfW, float halfH, unsigned char c, float r, float g, float b, float a) {
+    if (c < GLYPH_COUNT && glyphRows) add(x, y, halfW, halfH, r, g, b, a, GLYPH).param = c;
+}
+
+void ShapeBatch::bindInstanceAttributes(size_t offset) {
+    GLsizei stride = sizeof(Instance);
+    const char* base = (const char*)offset;
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, base + offsetof(Instance, x));
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, stride, base + offsetof(Instance, param));
+    glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, base + offsetof(Instance, color));
+    glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, base + offsetof(Instance, color2));
+    glVertexAttribPointer(5, 1, GL_UNSIGNED_BYTE, GL_FALSE, stride, base + offsetof(Instance, shape));
+}
+
+void ShapeBatch::flush() {
+    if (shapes.empty()) return;
+    if (!instanced()) { drawImmediate(); shapes.clear(); return; }
+
+    size_t bytes = shapes.size() * sizeof(Instance);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    if (streamOffset + bytes > streamCapacity) {
+        // Orphaning hands the driver a fresh store, so the ranges the GPU
+        // may still be reading are never written again
+        if (bytes > streamCapacity) streamCapacity = 2 * bytes;
+        glBufferData(GL_ARRAY_BUFFER, streamCapacity, NULL, GL_STREAM_DRAW);
+        streamOffset = 0;
+    }
+    void* dst = glMapBufferRange(GL_ARRAY_BUFFER, streamOffset, bytes,
+                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (dst) {
+        memcpy(dst, shapes.data(), bytes);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    } else glBufferSubData(GL_ARRAY_BUFFER, streamOffset, bytes, shapes.data());
+    bindInstanceAttributes(streamOffset);
+    streamOffset += bytes;
+
+    glUseProgram(program);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, glyphTexture);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)shapes.size());
+    drawCounters.add(4 * (long long)shapes.size());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    shapes.clear();
+}
+
+// ---- Immediate-mode fallback ----
+static void quad(float x0, float y0, float x1, float y1) {
+    glBegin(GL_QUADS);
+    glVertex2f(x0, y0); glVertex2f(x1, y0); glVertex2f(x1, y1); glVertex2f(x0, y1);
+    glEnd();
+    drawCounters.add(4);
+}
+
+void ShapeBatch::drawImmediate() const {
+    for (const Instance& s : shapes) {
+        glColor4ub(s.color[0], s.color[1], s.color[2], s.color[3]);
+        float x0 = s.x - s.halfW, x1 = s.x + s.halfW, y0 = s.y - s.halfH, y1 = s.y + s.halfH;
+        switch (s.shape) {
+            case RECT:
+                quad(x0, y0, x1, y1);
+                break;
+            case GRADIENT:
+                glBegin(GL_QUADS);
+                glVertex2f(x0, y1); glVertex2f(x1, y1);
+                glColor4ub(s.color2[0], s.color2[1], s.color2[2], s.color2[3]);
+                glVertex2f(x1, y0); glVertex2f(x0, y0);
+                glEnd();
+                drawCounters.add(4);
+                break;
+            case GLYPH: {
+                // One quad per lit pixel, slightly oversized so neighbours meet
+                float pw = 2.0f * s.halfW / 5.0f, ph = 2.0f * s.halfH / 7.0f;
+                const uint8_t* rows = glyphRows + (int)s.param * 7;
+                for (int row = 0; row < 7; row++)
+                    for (int col = 0; col < 5; col++)
+                        if (rows[row] >> (4 - col) & 1) {
+                            float px = x0 + col * pw, py = y1 - (row + 1) * ph;
+                            quad(px, py, px + pw * 1.05f, py + ph * 1.05f);
+                        }
+                break;
+            }
+            case ROUNDED_RECT: {
+                float rad = s.param;
+                quad(x0 + rad, y0, x1 - rad, y1);
+                quad(x0, y0 + rad, x0 + rad, y1 - rad);
+                quad(x1 - rad, y0 + rad, x1, y1 - rad);
+                int segments = circleSegments(rad * pixelsPerUnit);
+                const ArcPoint* arc = unitCircle(segments);
+                for (int corner = 0; corner < 4; corner++) {
+                    float cx, cy;
+                    int quarter;  // corner arcs start at 180, 270, 0 and 90 degrees
+                    switch (corner) {
+                        case 0: cx = x0 + rad; cy = y0 + rad; quarter = 2; break;
+                        case 1: cx = x1 - rad; cy = y0 + rad; quarter = 3; break;
+                        case 2: cx = x1 - rad; cy = y1 - rad; quarter = 0; break;
+                        default: cx = x0 + rad; cy = y1 - rad; quarter = 1; break;
+                    }
+                    const ArcPoint* p = arc + quarter * segments / 4;
+                    glBegin(GL_TRIANGLE_FAN);
+                    glVertex2f(cx, cy);
+                    for (int i = 0; i <= segments / 4; i++) glVertex2f(cx + rad * p[i].c, cy + rad * p[i].s);
+                    glEnd();
+                    drawCounters.add(segments / 4 + 2);
+                }
+                break;
+            }
+            default: {
+                int segments = circleSegments(s.halfW * pixelsPerUnit);
+                const ArcPoint* p = unitCircle(segments);
+                glBegin(GL_TRIANGLE_FAN);
+                glVertex2f(s.x, s.y);
+                for (int i = 0; i <= segments; i++) glVertex2f(s.x + s.halfW * p[i].c, s.y + s.halfH * p[i].s);
+                glEnd();
+                drawCounters.add(segments + 2);
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+// Collects everything 2D the game draws (circles, rectangles, rounded
+// rectangles, vertical gradients and font glyphs) and draws it with one
+// instanced call per flush: every shape is a unit quad stretched by its
+// instance data, and the fragment shader cuts circles and rounded corners
+// with a signed distance (antialiased over one pixel) and looks glyphs up
+// in a font texture. Shapes are drawn in the order they were added, so
+// later ones blend over earlier ones as with immediate mode. Callers add
+// freely and flush only where GL state changes (scissor, framebuffer) and
+// at the end of the frame.
+//
+// Instance data streams through one buffer allocated up front: each flush
+// maps the next unused range unsynchronized and the buffer is orphaned when
+// it wraps, so uploads never wait on the GPU. (A GL 4.4 persistent mapping
+// would save the map call, but the loader here stops at 3.3.)
+//
+// Without GL 3.3 shaders flush() falls back to one immediate-mode
+// primitive per shape, which needs the legacy (compatibility) context.
+class ShapeBatch {
+public:
+    // Needs a current GL context; returns false (and keeps the fallback)
+    // when the shader path cannot be set up
+    bool init();
+    bool instanced() const { return program != 0; }
+    // Framebuffer size in pixels; the immediate-mode fallback picks circle
+    // detail from it
+    void setViewport(int width, int height) { pixelsPerUnit = 0.5f * (width > height ? width : height); }
+    // 128 glyphs of 7 row bitmasks each, bit 4 the leftmost of 5 columns;
+    // must stay valid while glyphs are drawn
+    void setGlyphs(const uint8_t* rows);
+
+    void begin() { shapes.clear(); }
+    // Centre and radius/half size in NDC, the same units as glVertex2f here
+    void circle(float x, float y, float radius, float r, float g, float b, float a);
+    void square(float x, float y, float halfSize, float r, float g, float b, float a) {
+        rect(x, y, halfSize, halfSize, r, g, b, a);
+    }
+    void rect(float x, float y, float halfW, float halfH, float r, float g, float b, float a);
+    void roundedRect(float x, float y, float halfW, float halfH, float radius, float r, float g, float b, float a);
+    // Colour `top` fading linearly to `bottom`; both are RGBA
+    void gradient(float x, float y, float halfW, float halfH, const float* top, const float* bottom);
+    // Glyph `c` stretched over the box, lit pixels only
+    void glyph(float x, float y, float halfW, float halfH, unsigned char c, float r, float g, float b, float a);
+    // Draws everything added since the last flush and empties the batch
+    void flush();
+
+    size_t size() const { return shapes.size(); }
+
+private:
+    enum Shape : uint8_t { CIRCLE, RECT, ROUNDED_RECT, GLYPH, GRADIENT };
+    struct Instance {
+        float x, y, halfW, halfH;
+        float param;  // corner radius or glyph code
+        uint8_t color[4];
+        uint8_t color2[4];  // gradient bottom
+        uint8_t shape, pad[3];
+    };
+    std::vector<Instance> shapes;
+
+    GLuint program = 0, vao = 0, quadVbo = 0, instanceVbo = 0, glyphTexture = 0;
+    size_t streamCapacity = 0, streamOffset = 0;  // bytes in instanceVbo, next free byte
+    const uint8_t* glyphRows = nullptr;
+    float pixelsPerUnit = 500.0f;
+
+    Instance& add(float x, float y, float halfW, float halfH, float r, float g, float b, float a, Shape shape);
+    void uploadGlyphs();
+    void bindInstanceAttributes(size_t offset);
+    void drawImmediate() const;
+};
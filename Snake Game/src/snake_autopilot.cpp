@@ -0,0 +1,300 @@
+#include "snake_autopilot.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+// The bitboards and the cycle are only used on boards within the search
+// budget
+Autopilot::Autopilot(int width, int height)
+    : gridW(width), gridH(height), cells(width * height), budget(std::min(width * height, SEARCH_BUDGET)),
+      visitOf(width * height), queue(budget), visitDist(budget), visitParent(budget), visitFirst(budget),
+      entered(width * height),
+      walls(cells <= SEARCH_BUDGET ? width : 1, cells <= SEARCH_BUDGET ? height : 1),
+      region(cells <= SEARCH_BUDGET ? width : 1, cells <= SEARCH_BUDGET ? height : 1),
+      cycleNext(cells <= SEARCH_BUDGET ? cells : 0) {}
+
+int Autopilot::neighbor(int c, int d) const {
+    int x = c % gridW, y = c / gridW;
+    switch (d) {
+        case UP:    y = (y + 1 == gridH) ? 0 : y + 1; break;
+        case DOWN:  y = (y == 0) ? gridH - 1 : y - 1; break;
+        case LEFT:  x = (x == 0) ? gridW - 1 : x - 1; break;
+        case RIGHT: x = (x + 1 == gridW) ? 0 : x + 1; break;
+    }
+    return y * gridW + x;
+}
+
+void Autopilot::visit(int c, int dist, int parent, int firstMove) {
+    visitOf[c] = visited;
+    queue[visited] = c;
+    visitDist[visited] = dist;
+    visitParent[visited] = parent;
+    visitFirst[visited] = (int8_t)firstMove;
+    ++visited;
+}
+
+// path[j] is j cells back from the look-ahead head; the snake covers the
+// first lookLen cells of path followed by the sim's body
+void Autopilot::enterPath(const SnakeSim& sim, bool grow) {
+    lookSim = &sim;
+    lookLen = sim.length() + (grow ? 1 : 0);
+    for (size_t j = 0; j < path.size() && (int)j < lookLen; ++j) entered[path[j]] = 1;
+}
+
+void Autopilot::leavePath() {
+    for (int c : path) entered[c] = 0;
+}
+
+bool Autopilot::lookOccupied(int c) const {
+    if (entered[c]) return true;
+    int i = lookSim->segmentAtCell(c);
+    return i >= 0 && (int)path.size() + i < lookLen;
+}
+
+// BFS on the look-ahead snake from its head to its tail cell
+bool Autopilot::tailReachable(int* distance) {
+    int steps = (int)path.size(), head = path[0], tail;
+    if (lookLen - 1 < steps) tail = path[lookLen - 1];
+    else {
+        Point p = lookSim->segment(lookLen - 1 - steps);
+        tail = lookSim->cellIndex(p.x, p.y);
+    }
+    visited = 0;
+    int qHead = 0;
+    visit(head, 0, -1, 0);
+    while (qHead < visited) {
+        int v = qHead++, c = queue[v];
+        for (int d = UP; d <= RIGHT; ++d) {
+            int n = neighbor(c, d);
+            if (seen(n)) continue;
+            if (n == tail) { *distance = visitDist[v] + 1; return true; }
+            if (lookOccupied(n)) continue;
+            if (visited == budget) { *distance = visitDist[v] + 1; return true; }  // room enough
+            visit(n, visitDist[v] + 1, v, 0);
+        }
+    }
+    return false;
+}
+
+// Cells reachable from start through cells the body has left by next tick,
+// up to the budget
+int Autopilot::roomFrom(const SnakeSim& sim, int start) {
+    visited = 0;
+    int qHead = 0;
+    visit(start, 0, -1, 0);
+    while (qHead < visited) {
+        int v = qHead++, c = queue[v];
+        for (int d = UP; d <= RIGHT; ++d) {
+            int n = neighbor(c, d);
+            if (seen(n) || vacateAt(sim, n) > 1) continue;
+            if (visited == budget) return visited;
+            visit(n, visitDist[v] + 1, v, 0);
+        }
+    }
+    return visited;
+}
+
+// Shortest path from `from` to `to` through free cells not yet on the
+// route (never back into the neck), left in the visit arrays
+bool Autopilot::freePath(const SnakeSim& sim, int from, int to) {
+    Point hp = sim.head();
+    int back = from == sim.cellIndex(hp.x, hp.y) ? neighbor(from, opposite(sim.direction())) : -1;
+    visited = 0;
+    int qHead = 0;
+    visit(from, 0, -1, 0);
+    while (qHead < visited && !seen(to)) {
+        int v = qHead++, c = queue[v];
+        for (int d = UP; d <= RIGHT; ++d) {
+            int n = neighbor(c, d);
+            if (n == back || seen(n)) continue;
+            if (n != to && (entered[n] || vacateAt(sim, n) > 0)) continue;
+            visit(n, visitDist[v] + 1, v, 0);
+        }
+    }
+    return seen(to);
+}
+
+// Moves the pending cells onto the route, from the first step after `hold`
+// swapping each step for a three-step detour through a free pair beside it
+// while there is one
+void Autopilot::stretchRoute(const SnakeSim& sim, size_t hold) {
+    while (!pending.empty()) {
+        int a = route.back(), b = pending.back();
+        bool stretched = false;
+        for (int d = UP; d <= RIGHT && !stretched && route.size() > hold; ++d) {
+            int a2 = neighbor(a, d), b2 = neighbor(b, d);
+            if (a2 == b || b2 == a || entered[a2] || entered[b2] || vacateAt(sim, a2) || vacateAt(sim, b2)) continue;
+            entered[a2] = entered[b2] = 1;
+            pending.push_back(b2);
+            pending.push_back(a2);
+            stretched = true;
+        }
+        if (!stretched) route.push_back(b), pending.pop_back();
+    }
+}
+
+// A route from the head to the tail, by way of the food once a cycle is
+// locked (if free cells lead there), then back along the body to the neck.
+// The tail leaves each body cell before the head gets there, so with the
+// head's cell the route is a cycle the snake can follow for ever.
+// Stretching the part after the food first keeps the food near; only a
+// route that takes in every cell counts, and foodAt is then the food's
+// place on it.
+bool Autopilot::planCycle(const SnakeSim& sim, int head, int food, int* foodAt) {
+    int len = sim.length();
+    if (len < 2) return false;
+    Point tp = sim.segment(len - 1);
+    int tail = sim.cellIndex(tp.x, tp.y);
+    path.clear();
+    if (cycleLocked && freePath(sim, head, food))
+        for (int v = visitOf[food]; v != 0; v = visitParent[v]) path.push_back(queue[v]);
+    entered[head] = 1;
+    for (int c : path) entered[c] = 1;
+    if (!freePath(sim, path.empty() ? head : food, tail)) {
+        entered[head] = 0;
+        leavePath();
+        return false;
+    }
+
+    pending.clear();
+    for (int i = 1; i < len - 1; ++i) {
+        Point p = sim.segment(i);
+        pending.push_back(sim.cellIndex(p.x, p.y));
+    }
+    for (int v = visitOf[tail]; v != 0; v = visitParent[v]) pending.push_back(queue[v]);
+    pending.insert(pending.end(), path.begin(), path.end());
+    for (int c : pending) entered[c] = 1;
+    route.assign(1, head);
+    stretchRoute(sim, path.size());
+    if ((int)route.size() < cells && !path.empty()) {
+        for (size_t j = route.size() - 1; j > 0; --j) pending.push_back(route[j]);
+        route.resize(1);
+        stretchRoute(sim, 0);
+    }
+    for (int c : route) entered[c] = 0;
+    if ((int)route.size() != cells) return false;
+    *foodAt = (int)(std::find(route.begin(), route.end(), food) - route.begin());
+    return true;
+}
+
+Direction Autopilot::followCycle(const SnakeSim& sim, int head) {
+    cycleExpect = cycleNext[head];
+    cycleTick = sim.ticks();
+    for (int d = UP; d <= RIGHT; ++d)
+        if (neighbor(head, d) == cycleExpect) return (Direction)d;
+    return sim.direction();
+}
+
+Direction Autopilot::decide(const SnakeSim& sim) {
+    Direction cur = sim.direction();
+    if (!sim.hasFood()) return cur;
+    int len = sim.length();
+    if (len != lastLength || sim.ticks() < lastMeal) lastLength = len, lastMeal = sim.ticks();
+    Point hp = sim.head(), fp = sim.food();
+    int head = sim.cellIndex(hp.x, hp.y), food = sim.cellIndex(fp.x, fp.y);
+
+    // 1. Once the snake is long, keep to a cycle over the whole board,
+    // switching to a new one whenever that reaches the food sooner
+    if (cycleLocked && !(sim.ticks() == cycleTick + 1 && head == cycleExpect && vacateAt(sim, cycleNext[head]) <= 1))
+        cycleLocked = false;
+    bool replan = cells <= SEARCH_BUDGET && len * 4 >= cells &&
+                  (!cycleLocked || food != planFood || sim.ticks() >= planTick + REPLAN_TICKS);
+    if (replan) planFood = food, planTick = sim.ticks();
+    int foodAt;
+    if (replan && planCycle(sim, head, food, &foodAt)) {
+        int ahead = 0;
+        if (cycleLocked)
+            for (int c = head; c != food; c = cycleNext[c]) ++ahead;
+        if (!cycleLocked || foodAt < ahead) {
+            for (int j = 0; j + 1 < cells; ++j) cycleNext[route[j]] = route[j + 1];
+            cycleNext[route[cells - 1]] = head;
+            cycleLocked = true;
+        }
+    }
+    if (cycleLocked) return followCycle(sim, head);
+
+    // 2. Shortest path to the food through cells that are free on arrival
+    // (segment i leaves its cell after len - i ticks; the tail after one)
+    visited = 0;
+    int qHead = 0;
+    bool exhausted = false;
+    visit(head, 0, -1, cur);
+    while (qHead < visited && !seen(food) && !exhausted) {
+        int v = qHead++, c = queue[v];
+        for (int d = UP; d <= RIGHT; ++d) {
+            if (c == head && d == opposite(cur)) continue;
+            int n = neighbor(c, d);
+            if (seen(n) || vacateAt(sim, n) > visitDist[v] + 1) continue;
+            if (visited == budget) { exhausted = true; break; }
+            visit(n, visitDist[v] + 1, v, c == head ? d : visitFirst[v]);
+        }
+    }
+    // Out of budget on a big board: make for the visited cell nearest the food
+    int target = seen(food) ? visitOf[food] : 0;
+    if (!target && exhausted) {
+        auto around = [](int delta, int size) { delta = std::abs(delta); return std::min(delta, size - delta); };
+        int nearest = INT_MAX;
+        for (int v = 1; v < visited; ++v) {
+            int c = queue[v];
+            int distance = around(c % gridW - fp.x, gridW) + around(c / gridW - fp.y, gridH);
+            if (distance < nearest) nearest = distance, target = v;
+        }
+    }
+
+    // 3. Take it only if the tail stays reachable once we get there
+    if (target > 0) {
+        Direction move = (Direction)visitFirst[target];
+        bool eats = queue[target] == food;
+        if (eats && len + 1 >= cells) return move;
+        path.clear();
+        for (int v = target; v != 0; v = visitParent[v]) path.push_back(queue[v]);
+        enterPath(sim, eats);
+        int unused;
+        bool safe = tailReachable(&unused);
+        leavePath();
+        if (safe) return move;
+    }
+
+    // 4. Chase the tail the long way round until the food is safe
+    // (after a full lap without eating, take the safe moves in a shuffled
+    // order instead so a fixed loop around the food is broken)
+    bool stalled = sim.ticks() - lastMeal > cells;
+    uint32_t shuffle = (uint32_t)sim.ticks() * 2654435761u;
+    Direction best = cur;
+    long long bestKey = -1;
+    for (int d = UP; d <= RIGHT; ++d) {
+        if (d == opposite(cur)) continue;
+        int n = neighbor(head, d);
+        if (vacateAt(sim, n) > 1 || n == food) continue;
+        path.assign(1, n);
+        enterPath(sim, false);
+        int distance;
+        bool reachable = tailReachable(&distance);
+        leavePath();
+        if (!reachable) continue;
+        long long key = stalled ? (shuffle >> (8 * d)) & 0xff : distance;
+        if (key > bestKey) bestKey = key, best = (Direction)d;
+    }
+    if (bestKey >= 0) return best;
+
+    // 5. Boxed in: go where there is the most room, counting anything the
+    // tail frees next tick as open
+    bool small = cells <= SEARCH_BUDGET;
+    if (small) {
+        walls.clear();
+        for (int i = 0; i < len - 1; ++i) {
+            Point p = sim.segment(i);
+            walls.set(p.x, p.y);
+        }
+    }
+    int bestArea = -1;
+    for (int d = UP; d <= RIGHT; ++d) {
+        if (d == opposite(cur)) continue;
+        int n = neighbor(head, d);
+        if (vacateAt(sim, n) > 1) continue;
+        int area = small ? region.floodFill(walls, n % gridW, n / gridW) : roomFrom(sim, n);
+        if (area > bestArea) bestArea = area, best = (Direction)d;
+    }
+    return best;
+}
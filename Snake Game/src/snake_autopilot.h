@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "snake_bitboard.h"
+#include "snake_sim.h"
+
+// Bot that drives a SnakeSim on the wrapping board. Each decision:
+//  1. Once the snake covers a quarter of the board, plans a cycle over the
+//     whole board that runs from the head to the tail and back along the
+//     body: a shortest path stretched with two-cell detours until it takes
+//     in every free cell. Following such a cycle never fails and eats each
+//     food as it comes round, so once one is found the bot keeps to it,
+//     replanning by way of the food and switching whenever that reaches
+//     the food sooner. Without it the endgame can wait for ever on a food
+//     that never becomes safe.
+//  2. Otherwise BFS from the head to the food, treating a body cell as
+//     free once the tail will have moved off it by the time the head
+//     arrives.
+//  3. Replays that path on a look-ahead copy of the body and takes it only
+//     if the tail is still reachable from the head after eating.
+//  4. Otherwise follows its own tail, preferring the move that keeps the
+//     tail farthest away, which stalls until the food becomes safe.
+//  5. If even that fails, takes the move with the most reachable cells,
+//     counted with a bitboard flood fill.
+// Nothing is cleared per decision: the search state is a sparse set over
+// the visited cells, and when a body cell frees up comes from the sim's own
+// cell -> segment map. A search visits at most SEARCH_BUDGET cells, so on
+// boards up to that size play is exact and on bigger ones a decision costs
+// the same however big the board is. There a food search that runs out
+// heads for the visited cell nearest the food, and a tail search that runs
+// out counts as reachable (that much room is plenty for now). Cycles are
+// only closed on boards within the budget.
+class Autopilot {
+public:
+    static const int SEARCH_BUDGET = 1 << 16;  // a 256 x 256 board
+    static const int REPLAN_TICKS = 16;  // ticks a locked cycle goes unchecked for a shortcut
+
+    Autopilot(int width, int height);
+
+    Direction decide(const SnakeSim& sim);
+
+private:
+    int gridW, gridH, cells;
+    int budget;  // cells one search may visit, min(cells, SEARCH_BUDGET)
+
+    // Search state for the cells visited so far, in visit order. visitOf[c]
+    // is c's index there, valid only when queue[visitOf[c]] == c, so the
+    // per-cell array is never cleared.
+    std::vector<int32_t> visitOf;
+    std::vector<int32_t> queue;
+    std::vector<int32_t> visitDist;
+    std::vector<int32_t> visitParent;  // visit index of the cell reached from
+    std::vector<int8_t> visitFirst;    // direction of the first step on the path
+    int visited = 0;
+    std::vector<int32_t> path;  // cells entered, last first
+    // Look-ahead snake: the sim's body after moving along `path`, growing on
+    // the last step if it eats. Cells it has entered and still covers are
+    // marked in `entered`; the sim's own segments count while they have not
+    // yet left.
+    std::vector<uint8_t> entered;
+    const SnakeSim* lookSim = nullptr;
+    int lookLen = 0;
+    Bitboard walls, region;
+    // Route being stretched: cells placed so far from the head, and the
+    // cells still to place, next last
+    std::vector<int32_t> route, pending;
+    // Locked cycle: cycleNext[c] follows c. It holds while the head keeps to
+    // it, checked by where the previous decision sent the head. While locked
+    // a shorter way to the food is looked for when the food moves and every
+    // REPLAN_TICKS ticks, not on every tick.
+    std::vector<int32_t> cycleNext;
+    bool cycleLocked = false;
+    int cycleExpect = -1;
+    long long cycleTick = -1;
+    int planFood = -1;
+    long long planTick = -1;
+    // Tick of the last length change, for breaking tail-chasing loops
+    int lastLength = 0;
+    long long lastMeal = 0;
+
+    int neighbor(int c, int d) const;
+    // Ticks until the body leaves cell c, 0 when it is free
+    int vacateAt(const SnakeSim& sim, int c) const {
+        int i = sim.segmentAtCell(c);
+        return i < 0 ? 0 : sim.length() - i;
+    }
+    bool seen(int c) const { int v = visitOf[c]; return (unsigned)v < (unsigned)visited && queue[v] == c; }
+    void visit(int c, int dist, int parent, int firstMove);
+    void enterPath(const SnakeSim& sim, bool grow);
+    void leavePath();
+    bool lookOccupied(int c) const;
+    bool tailReachable(int* distance);
+    int roomFrom(const SnakeSim& sim, int start);
+    bool freePath(const SnakeSim& sim, int from, int to);
+    void stretchRoute(const SnakeSim& sim, size_t hold);
+    bool planCycle(const SnakeSim& sim, int head, int food, int* foodAt);
+    Direction followCycle(const SnakeSim& sim, int head);
+};
@@ -0,0 +1,149 @@
+#include "snake_batch.h"
+
+#include <cstring>
+
+SnakeBatch::SnakeBatch(int count, int width, int height, uint64_t seed)
+    : n(count), gridW(width), gridH(height), cells(width * height), planeWords((width * height + 63) / 64),
+      hx(count), hy(count), tx(count), ty(count), dirs(count), lens(count), food(count), score(count),
+      headSlot(count), rngs(count), occ((size_t)count * planeWords), moves((size_t)count * width * height),
+      nextCell(count), eats(count), died(count),
+      doneFlag(count), lastComplete(count), lastScore(count) {
+    for (int i = 0; i < count; ++i) rngs[i].reseed(seed, (uint64_t)i);
+    resetAll();
+}
+
+void SnakeBatch::resetAll() {
+    for (int i = 0; i < n; ++i) {
+        resetGame(i);
+        doneFlag[i] = 0;
+    }
+    stepCount = episodeCount = 0;
+}
+
+void SnakeBatch::resetGame(int i) {
+    uint64_t* o = occ.data() + (size_t)i * planeWords;
+    memset(o, 0, planeWords * sizeof(uint64_t));
+    hx[i] = tx[i] = gridW / 2;
+    hy[i] = ty[i] = gridH / 2;
+    dirs[i] = RIGHT;
+    lens[i] = 1;
+    score[i] = 0;
+    headSlot[i] = 0;
+    moves[(size_t)i * cells] = RIGHT;
+    int c = hy[i] * gridW + hx[i];
+    o[c >> 6] |= 1ull << (c & 63);
+    placeFood(i);
+}
+
+// Uniform over free cells. Rejection sampling while at least a quarter of the
+// board is free (at most 4 draws expected), otherwise pick the k-th free cell
+// by popcounting the bitplane, which keeps the batch free of a per-game
+// free-cell index.
+void SnakeBatch::placeFood(int i) {
+    const uint64_t* o = occ.data() + (size_t)i * planeWords;
+    int freeCells = cells - lens[i];
+    if (freeCells * 4 >= cells) {
+        int c;
+        do c = (int)rngs[i].below(cells); while ((o[c >> 6] >> (c & 63)) & 1);
+        food[i] = c;
+        return;
+    }
+    int k = (int)rngs[i].below(freeCells);
+    for (int w = 0; w < planeWords; ++w) {
+        uint64_t freeBits = ~o[w];
+        if (w == planeWords - 1 && (cells & 63)) freeBits &= (1ull << (cells & 63)) - 1;
+        int count = __builtin_popcountll(freeBits);
+        if (k >= count) { k -= count; continue; }
+        while (k--) freeBits &= freeBits - 1;
+        food[i] = w * 64 + __builtin_ctzll(freeBits);
+        return;
+    }
+}
+
+void SnakeBatch::finishGame(int i, bool complete) {
+    doneFlag[i] = 1;
+    lastComplete[i] = complete;
+    lastScore[i] = score[i];
+    ++episodeCount;
+    resetGame(i);
+}
+
+// Turn, move, wrap and test for food in every game. Branch-free selects only
+// and restrict-qualified arrays, so the compiler can vectorize the loop.
+static void moveHeads(int count, int w, int h, const uint8_t* __restrict actions,
+                      uint8_t* __restrict d, int32_t* __restrict x, int32_t* __restrict y,
+                      const int32_t* __restrict food, int32_t* __restrict next,
+                      uint8_t* __restrict eat, uint8_t* __restrict fin) {
+    for (int i = 0; i < count; ++i) {
+        int cur = d[i], a = actions[i];
+        int nd = (a == (cur ^ 1)) ? cur : a;
+        int nx = x[i] + (nd == RIGHT) - (nd == LEFT);
+        int ny = y[i] + (nd == UP) - (nd == DOWN);
+        nx = nx < 0 ? w - 1 : (nx >= w ? 0 : nx);
+        ny = ny < 0 ? h - 1 : (ny >= h ? 0 : ny);
+        int c = ny * w + nx;
+        d[i] = (uint8_t)nd;
+        x[i] = nx;
+        y[i] = ny;
+        next[i] = c;
+        eat[i] = c == food[i];
+        fin[i] = 0;
+    }
+}
+
+static void growSnakes(int count, const uint8_t* __restrict eat, const uint8_t* __restrict hit,
+                       int32_t* __restrict len, int32_t* __restrict score) {
+    for (int i = 0; i < count; ++i) {
+        int grow = eat[i] & (hit[i] ^ 1);
+        len[i] += grow;
+        score[i] += grow * 10;
+    }
+}
+
+void SnakeBatch::step(const uint8_t* actions) {
+    const int w = gridW, h = gridH;
+    moveHeads(n, w, h, actions, dirs.data(), hx.data(), hy.data(), food.data(),
+              nextCell.data(), eats.data(), doneFlag.data());
+
+    // Tail out, head in. This is the only pass that touches per-game planes.
+    const uint8_t* d = dirs.data();
+    const uint8_t* eat = eats.data();
+    const int32_t* next = nextCell.data();
+    uint8_t* hit = died.data();
+    for (int i = 0; i < n; ++i) {
+        uint64_t* o = occ.data() + (size_t)i * planeWords;
+        uint8_t* m = moves.data() + (size_t)i * cells;
+        int hs = headSlot[i];
+        if (!eat[i]) {
+            int t = ty[i] * w + tx[i];
+            o[t >> 6] &= ~(1ull << (t & 63));
+            // The tail steps along the move that entered the segment ahead of it
+            int s = hs + lens[i] - 2;
+            if (s >= cells) s -= cells;
+            int td = lens[i] > 1 ? m[s] : d[i];
+            int ntx = tx[i] + (td == RIGHT) - (td == LEFT);
+            int nty = ty[i] + (td == UP) - (td == DOWN);
+            tx[i] = ntx < 0 ? w - 1 : (ntx >= w ? 0 : ntx);
+            ty[i] = nty < 0 ? h - 1 : (nty >= h ? 0 : nty);
+        }
+        hs = (hs == 0) ? cells - 1 : hs - 1;
+        headSlot[i] = hs;
+        m[hs] = d[i];
+        int c = next[i];
+        uint64_t bit = 1ull << (c & 63);
+        hit[i] = (o[c >> 6] & bit) != 0;
+        o[c >> 6] |= bit;
+    }
+
+    growSnakes(n, eat, hit, lens.data(), score.data());
+
+    // Rare per-game work: respawn food and restart finished games
+    for (int i = 0; i < n; ++i) {
+        if (hit[i]) finishGame(i, false);
+        else if (eat[i]) {
+            if (lens[i] == cells) finishGame(i, true);
+            else placeFood(i);
+        }
+    }
+    stepCount += n;
+}
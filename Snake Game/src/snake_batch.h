@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "snake_sim.h"
+
+// N independent Snake games stepped in lockstep, same rules as SnakeSim.
+// State is stored as structure-of-arrays (one array per field, indexed by
+// game) so the turn/move/wrap/eat pass is a straight loop over contiguous
+// arrays that the compiler can vectorize. Per-game memory is kept small so
+// thousands of games stay cache resident: occupancy is a bitplane and the
+// body is a ring of 2-bit moves (one byte each) walked by a head and a tail
+// cursor, so a step touches one occupancy word per end and the two cursor
+// bytes. Games that end are restarted in place and flagged in done().
+class SnakeBatch {
+public:
+    // Game i draws its food from stream i of `seed`
+    SnakeBatch(int count, int width, int height, uint64_t seed = 0);
+
+    void resetAll();
+    // Advances every game one tick; actions[i] is the Direction for game i
+    void step(const uint8_t* actions);
+
+    int size() const { return n; }
+    int width() const { return gridW; }
+    int height() const { return gridH; }
+    int cellCount() const { return cells; }
+
+    // Per-game state, indexed by game
+    const int32_t* headX() const { return hx.data(); }
+    const int32_t* headY() const { return hy.data(); }
+    const int32_t* tailX() const { return tx.data(); }
+    const int32_t* tailY() const { return ty.data(); }
+    const uint8_t* directions() const { return dirs.data(); }
+    const int32_t* lengths() const { return lens.data(); }
+    const int32_t* foodCells() const { return food.data(); }
+    const int32_t* scores() const { return score.data(); }
+    // Occupancy bitplane of game i: bit c of the row-major cell index
+    const uint64_t* occupancy(int i) const { return occ.data() + (size_t)i * planeWords; }
+    bool isOccupied(int i, int x, int y) const {
+        int c = y * gridW + x;
+        return (occupancy(i)[c >> 6] >> (c & 63)) & 1;
+    }
+
+    // Games that ended on the last step, and their final score and outcome
+    const uint8_t* done() const { return doneFlag.data(); }
+    const int32_t* episodeScores() const { return lastScore.data(); }
+    const uint8_t* boardComplete() const { return lastComplete.data(); }
+
+    long long steps() const { return stepCount; }
+    long long episodes() const { return episodeCount; }
+
+private:
+    int n, gridW, gridH, cells, planeWords;
+
+    std::vector<int32_t> hx, hy, tx, ty;
+    std::vector<uint8_t> dirs;
+    std::vector<int32_t> lens, food, score;
+    std::vector<int32_t> headSlot;
+    std::vector<Pcg32> rngs;
+    // Per-game planes: planeWords occupancy words, and `cells` move bytes where
+    // moves[(headSlot + k) % cells] is the direction that entered segment k
+    std::vector<uint64_t> occ;
+    std::vector<uint8_t> moves;
+
+    // Scratch written by the vector pass
+    std::vector<int32_t> nextCell;
+    std::vector<uint8_t> eats, died;
+
+    std::vector<uint8_t> doneFlag, lastComplete;
+    std::vector<int32_t> lastScore;
+    long long stepCount = 0, episodeCount = 0;
+
+    void resetGame(int i);
+    void placeFood(int i);
+    void finishGame(int i, bool complete);
+};
@@ -0,0 +1,90 @@
+#include "snake_bitboard.h"
+
+#include <algorithm>
+
+Bitboard::Bitboard(int width, int height)
+    : gridW(width), gridH(height), stride((width + 63) / 64),
+      lastWordMask(width % 64 ? (1ull << (width % 64)) - 1 : ~0ull),
+      bits((size_t)height * stride), open((size_t)height * stride),
+      front((size_t)(height + 2) * stride), back((size_t)(height + 2) * stride) {}
+
+void Bitboard::clear() {
+    std::fill(bits.begin(), bits.end(), 0);
+}
+
+void Bitboard::loadPacked(const uint64_t* plane) {
+    clear();
+    for (int y = 0; y < gridH; ++y) {
+        uint64_t* r = row(y);
+        size_t bit = (size_t)y * gridW;
+        for (int i = 0; i < stride; ++i, bit += 64) {
+            int n = std::min(64, gridW - 64 * i);
+            uint64_t v = plane[bit >> 6] >> (bit & 63);
+            if ((bit & 63) + n > 64) v |= plane[(bit >> 6) + 1] << (64 - (bit & 63));
+            r[i] = n == 64 ? v : v & ((1ull << n) - 1);
+        }
+    }
+}
+
+int Bitboard::count() const {
+    int c = 0;
+    for (uint64_t w : bits) c += __builtin_popcountll(w);
+    return c;
+}
+
+// One generation of growth: every cell next to the region that is open joins
+// it. `cur` and `next` point at row 0 of buffers that also hold the row above
+// and below; rows of a single word (any board up to 64 wide) take the first
+// loop, which has no carries between words and vectorizes.
+void Bitboard::spread(const uint64_t* __restrict cur, uint64_t* __restrict next) const {
+    const uint64_t* __restrict o = open.data();
+    int s = stride, top = gridW - 1;
+    if (s == 1) {
+        for (int y = 0; y < gridH; ++y) {
+            uint64_t a = cur[y];
+            uint64_t side = (a << 1) | (a >> top) | (a >> 1) | ((a & 1) << top);
+            next[y] = ((side | cur[y - 1] | cur[y + 1]) & o[y]) | a;
+        }
+    } else {
+        int last = s - 1, topBit = top & 63;
+        for (int y = 0; y < gridH; ++y) {
+            const uint64_t* a = cur + (size_t)y * s;
+            uint64_t* n = next + (size_t)y * s;
+            const uint64_t* ro = o + (size_t)y * s;
+            for (int i = 0; i < s; ++i) {
+                uint64_t left = (a[i] << 1) | (i > 0 ? a[i - 1] >> 63 : (a[last] >> topBit) & 1);
+                uint64_t right = (a[i] >> 1) | (i < last ? a[i + 1] << 63 : (a[0] & 1) << topBit);
+                n[i] = ((left | right | a[i - s] | a[i + s]) & ro[i]) | a[i];
+            }
+        }
+    }
+    // Wrap rows: the copy above row 0 is the last row and vice versa
+    std::copy(next + (size_t)(gridH - 1) * s, next + (size_t)gridH * s, next - s);
+    std::copy(next, next + s, next + (size_t)gridH * s);
+}
+
+int Bitboard::floodFill(const Bitboard& walls, int x, int y) {
+    size_t words = (size_t)gridH * stride;
+    for (size_t i = 0; i < words; ++i) {
+        uint64_t valid = (i % stride == (size_t)stride - 1) ? lastWordMask : ~0ull;
+        open[i] = ~walls.bits[i] & valid;
+    }
+    uint64_t* cur = front.data() + stride;
+    uint64_t* next = back.data() + stride;
+    std::fill(front.begin(), front.end(), 0);
+    cur[(size_t)y * stride + (x >> 6)] = 1ull << (x & 63);
+    std::copy(cur + (size_t)(gridH - 1) * stride, cur + words, cur - stride);
+    std::copy(cur, cur + stride, cur + words);
+
+    // Two generations per convergence check; the region only ever grows, so
+    // it is complete once a generation adds nothing
+    for (;;) {
+        spread(cur, next);
+        spread(next, cur);
+        uint64_t changed = 0;
+        for (size_t i = 0; i < words; ++i) changed |= cur[i] ^ next[i];
+        if (!changed) break;
+    }
+    std::copy(cur, cur + words, bits.begin());
+    return count();
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One bit per cell of a wrapping width x height board, bit x of row y. Each
+// row is padded to whole 64-bit words (the 50x32 default board is 32 words,
+// one per row) so moving a row one cell sideways is a shift and moving it one
+// cell up or down is picking the next row, with no masking at row boundaries.
+class Bitboard {
+public:
+    Bitboard(int width, int height);
+
+    int width() const { return gridW; }
+    int height() const { return gridH; }
+    int rowWords() const { return stride; }
+
+    void clear();
+    void set(int x, int y) { row(y)[x >> 6] |= 1ull << (x & 63); }
+    void reset(int x, int y) { row(y)[x >> 6] &= ~(1ull << (x & 63)); }
+    bool test(int x, int y) const { return (row(y)[x >> 6] >> (x & 63)) & 1; }
+    // Loads a row-major plane with bit (y * width + x) per cell, the layout of
+    // SnakeBatch::occupancy()
+    void loadPacked(const uint64_t* plane);
+    int count() const;
+
+    uint64_t* row(int y) { return bits.data() + (size_t)y * stride; }
+    const uint64_t* row(int y) const { return bits.data() + (size_t)y * stride; }
+
+    // Replaces this board with the region connected to (x, y) through cells
+    // that are clear in `walls` (same size), moving in four directions with
+    // wraparound, and returns its cell count. (x, y) itself always belongs
+    // to the region so the fill can start on a snake's head.
+    int floodFill(const Bitboard& walls, int x, int y);
+
+private:
+    int gridW, gridH, stride;
+    uint64_t lastWordMask;  // valid bits of the last word of each row
+    std::vector<uint64_t> bits;
+    // Flood fill scratch: open cells, then two generations of the region with
+    // a copy of the last row before row 0 and of row 0 after the last row
+    std::vector<uint64_t> open, front, back;
+
+    void spread(const uint64_t* cur, uint64_t* next) const;
+};
@@ -0,0 +1,400 @@
+// Headless Snake runner: plays games back to back through SnakeSim with a
+// simple bot and reports throughput. No window, GL or display needed.
+#include "parallel_runner.h"
+#include "snake_autopilot.h"
+#include "snake_batch.h"
+#include "snake_bitboard.h"
+#include "snake_random.h"
+#include "snake_replay.h"
+#include "snake_sim.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum Policy { GREEDY, RANDOM, AUTOPILOT };
+static const char* POLICY_NAMES[] = {"greedy", "random", "autopilot"};
+
+struct Options {
+    long long ticks = 10000000;
+    int width = 50, height = 32;
+    uint64_t seed = 1;
+    Policy policy = GREEDY;
+    int batch = 0;  // > 0 runs that many games in lockstep through SnakeBatch
+    bool flood = false;  // batch mode: also time a reachable-area query from every head
+    int episodes = 0;  // > 0 runs that many full games on the thread pool
+    int threads = 0;   // 0 = one per hardware thread
+    long long maxSteps = 100000;  // per-episode cap so a looping bot cannot stall a worker
+    std::string recordDir;  // episodes mode: save a replay per game here
+    bool expectComplete = false;  // episodes mode: fail unless every game fills the board
+    std::string verifyDir;  // re-simulate every replay in this directory and check it
+};
+
+static void usage(const char* prog) {
+    printf("usage: %s [--ticks N] [--grid WxH] [--seed S] [--policy greedy|random|autopilot]\n"
+           "          [--batch N [--flood] | --episodes N [--threads T] [--max-steps M] [--record DIR]\n"
+           "                                 [--expect-complete]]\n"
+           "       %s --verify DIR [--threads T]\n", prog, prog);
+}
+
+static bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (!strcmp(a, "--ticks") && hasValue) opt.ticks = atoll(argv[++i]);
+        else if (!strcmp(a, "--grid") && hasValue) {
+            if (sscanf(argv[++i], "%dx%d", &opt.width, &opt.height) != 2) return false;
+        }
+        else if (!strcmp(a, "--batch") && hasValue) opt.batch = atoi(argv[++i]);
+        else if (!strcmp(a, "--flood")) opt.flood = true;
+        else if (!strcmp(a, "--episodes") && hasValue) opt.episodes = atoi(argv[++i]);
+        else if (!strcmp(a, "--threads") && hasValue) opt.threads = atoi(argv[++i]);
+        else if (!strcmp(a, "--max-steps") && hasValue) opt.maxSteps = atoll(argv[++i]);
+        else if (!strcmp(a, "--record") && hasValue) opt.recordDir = argv[++i];
+        else if (!strcmp(a, "--expect-complete")) opt.expectComplete = true;
+        else if (!strcmp(a, "--verify") && hasValue) opt.verifyDir = argv[++i];
+        else if (!strcmp(a, "--seed") && hasValue) opt.seed = strtoull(argv[++i], NULL, 10);
+        else if (!strcmp(a, "--policy") && hasValue) {
+            const char* p = argv[++i];
+            if (!strcmp(p, "greedy")) opt.policy = GREEDY;
+            else if (!strcmp(p, "random")) opt.policy = RANDOM;
+            else if (!strcmp(p, "autopilot")) opt.policy = AUTOPILOT;
+            else return false;
+        }
+        else return false;
+    }
+    return opt.ticks > 0 && opt.width > 1 && opt.height > 1 && opt.width <= MAX_GRID_SIDE
+        && opt.height <= MAX_GRID_SIDE && opt.batch >= 0
+        && opt.episodes >= 0 && opt.threads >= 0 && opt.maxSteps > 0
+        && !(opt.batch > 0 && opt.policy == AUTOPILOT);
+}
+
+// Game i draws food from stream i of the seed; the random policy driving it
+// uses its own stream far above those, so games never share a sequence
+const uint64_t POLICY_STREAM = 1ull << 62;
+
+static int wrapDistance(int a, int b, int size) {
+    int d = abs(a - b);
+    return d < size - d ? d : size - d;
+}
+
+// Of the moves that do not run into the body, take the one closest to the food
+static Direction greedyMove(const SnakeSim& sim) {
+    Point food = sim.hasFood() ? sim.food() : sim.head();
+    Direction best = sim.direction();
+    int bestScore = 1 << 30;
+    for (int d = UP; d <= RIGHT; ++d) {
+        Direction dir = (Direction)d;
+        if (dir == opposite(sim.direction())) continue;
+        Point next = sim.neighbor(sim.head(), dir);
+        int score = wrapDistance(next.x, food.x, sim.width()) + wrapDistance(next.y, food.y, sim.height());
+        if (sim.isOccupied(next.x, next.y)) score += 1 << 20;
+        if (score < bestScore) bestScore = score, best = dir;
+    }
+    return best;
+}
+
+// Same heuristic as greedyMove(), reading the batch's per-game arrays
+static void greedyMoves(const SnakeBatch& batch, uint8_t* out) {
+    const int w = batch.width(), h = batch.height();
+    for (int i = 0; i < batch.size(); ++i) {
+        int hx = batch.headX()[i], hy = batch.headY()[i];
+        int fx = batch.foodCells()[i] % w, fy = batch.foodCells()[i] / w;
+        int cur = batch.directions()[i];
+        int best = cur, bestScore = 1 << 30;
+        for (int d = UP; d <= RIGHT; ++d) {
+            if (d == (cur ^ 1)) continue;
+            int nx = hx + (d == RIGHT) - (d == LEFT), ny = hy + (d == UP) - (d == DOWN);
+            nx = nx < 0 ? w - 1 : (nx >= w ? 0 : nx);
+            ny = ny < 0 ? h - 1 : (ny >= h ? 0 : ny);
+            int score = wrapDistance(nx, fx, w) + wrapDistance(ny, fy, h);
+            if (batch.isOccupied(i, nx, ny)) score += 1 << 20;
+            if (score < bestScore) bestScore = score, best = d;
+        }
+        out[i] = (uint8_t)best;
+    }
+}
+
+// Per-game decision maker. Autopilot decisions are timed so the runner can
+// report latency against the HARD tick interval (80 ms).
+struct Bot {
+    Policy policy;
+    Pcg32 rng;
+    std::unique_ptr<Autopilot> pilot;
+    std::vector<float> latencyUs, nearFullUs;  // all decisions / at >= 90% board length
+
+    Bot(const Options& opt, uint64_t stream) : policy(opt.policy), rng(opt.seed, stream) {
+        if (policy == AUTOPILOT) pilot.reset(new Autopilot(opt.width, opt.height));
+    }
+
+    Direction move(const SnakeSim& sim) {
+        if (policy == RANDOM) return (Direction)rng.below(4);
+        if (policy == GREEDY) return greedyMove(sim);
+        auto start = std::chrono::steady_clock::now();
+        Direction d = pilot->decide(sim);
+        float us = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+        latencyUs.push_back(us);
+        if (sim.length() * 10 >= sim.cellCount() * 9) nearFullUs.push_back(us);
+        return d;
+    }
+};
+
+static void printLatency(const char* label, std::vector<float> samples) {
+    if (samples.empty()) return;
+    std::sort(samples.begin(), samples.end());
+    double mean = 0;
+    for (float s : samples) mean += s;
+    mean /= samples.size();
+    printf("%s %zu decisions  avg %.2f us  p50 %.2f us  p99 %.2f us  max %.2f us\n", label, samples.size(), mean,
+           samples[samples.size() / 2], samples[(size_t)(0.99 * (samples.size() - 1))], samples.back());
+}
+
+struct RunStats {
+    long long games = 0, wins = 0, scoreSum = 0;
+    int bestScore = 0;
+    void add(int score, bool complete) {
+        ++games;
+        if (complete) ++wins;
+        scoreSum += score;
+        if (score > bestScore) bestScore = score;
+    }
+};
+
+static long long runSingle(const Options& opt, RunStats& stats) {
+    SnakeSim sim(opt.width, opt.height, opt.seed, 0);
+    Bot bot(opt, POLICY_STREAM);
+    for (long long t = 0; t < opt.ticks; ++t) {
+        StepResult r = sim.step(bot.move(sim));
+        if (r == STEP_DIED || r == STEP_BOARD_COMPLETE) {
+            stats.add(sim.score(), r == STEP_BOARD_COMPLETE);
+            sim.reset();
+        }
+    }
+    printLatency("decide:", bot.latencyUs);
+    printLatency("  >=90%:", bot.nearFullUs);
+    return opt.ticks;
+}
+
+// Reference for the bitboard fill: cell-by-cell BFS over a batch game's
+// occupancy from its head (the head cell counts, like Bitboard::floodFill)
+static int bfsArea(const SnakeBatch& batch, int i, std::vector<uint8_t>& seen, std::vector<int32_t>& queue) {
+    const int w = batch.width(), h = batch.height();
+    std::fill(seen.begin(), seen.end(), 0);
+    int qHead = 0, qTail = 0;
+    int start = batch.headY()[i] * w + batch.headX()[i];
+    queue[qTail++] = start;
+    seen[start] = 1;
+    while (qHead < qTail) {
+        int c = queue[qHead++], x = c % w, y = c / w;
+        int next[4] = {((y + 1) % h) * w + x, ((y + h - 1) % h) * w + x, y * w + (x + w - 1) % w, y * w + (x + 1) % w};
+        for (int n : next) {
+            if (seen[n] || batch.isOccupied(i, n % w, n / w)) continue;
+            seen[n] = 1;
+            queue[qTail++] = n;
+        }
+    }
+    return qTail;
+}
+
+static void printNanos(const char* label, std::vector<float> samples) {
+    std::sort(samples.begin(), samples.end());
+    double mean = 0;
+    for (float s : samples) mean += s;
+    mean /= samples.size();
+    printf("%s avg %.0f ns  p50 %.0f ns  p99 %.0f ns\n", label, mean, samples[samples.size() / 2],
+           samples[(size_t)(0.99 * (samples.size() - 1))]);
+}
+
+static long long runBatch(const Options& opt, RunStats& stats) {
+    SnakeBatch batch(opt.batch, opt.width, opt.height, opt.seed);
+    Pcg32 policy(opt.seed, POLICY_STREAM);
+    std::vector<uint8_t> actions(opt.batch);
+    Bitboard walls(opt.width, opt.height), region(opt.width, opt.height);
+    std::vector<uint8_t> seen(opt.flood ? batch.cellCount() : 0);
+    std::vector<int32_t> queue(seen.size());
+    std::vector<float> fillNs, bfsNs;
+    long long mismatches = 0;
+    long long rounds = (opt.ticks + opt.batch - 1) / opt.batch;
+    for (long long r = 0; r < rounds; ++r) {
+        if (opt.flood) {
+            for (int i = 0; i < batch.size(); ++i) {
+                auto t0 = std::chrono::steady_clock::now();
+                walls.loadPacked(batch.occupancy(i));
+                int area = region.floodFill(walls, batch.headX()[i], batch.headY()[i]);
+                auto t1 = std::chrono::steady_clock::now();
+                int reference = bfsArea(batch, i, seen, queue);
+                auto t2 = std::chrono::steady_clock::now();
+                fillNs.push_back(std::chrono::duration<float, std::nano>(t1 - t0).count());
+                bfsNs.push_back(std::chrono::duration<float, std::nano>(t2 - t1).count());
+                if (area != reference) ++mismatches;
+            }
+        }
+        if (opt.policy == RANDOM) for (auto& a : actions) a = (uint8_t)policy.below(4);
+        else greedyMoves(batch, actions.data());
+        batch.step(actions.data());
+        const uint8_t* done = batch.done();
+        for (int i = 0; i < batch.size(); ++i)
+            if (done[i]) stats.add(batch.episodeScores()[i], batch.boardComplete()[i]);
+    }
+    if (opt.flood && !fillNs.empty()) {
+        printf("flood:  %zu queries, %lld disagree with BFS\n", fillNs.size(), mismatches);
+        printNanos("  bitboard:", fillNs);
+        printNanos("  bfs:     ", bfsNs);
+    }
+    return batch.steps();
+}
+
+static void printScoreDistribution(std::vector<int> scores) {
+    if (scores.empty()) return;
+    std::sort(scores.begin(), scores.end());
+    auto pct = [&](double p) { return scores[(size_t)(p * (scores.size() - 1) + 0.5)]; };
+    double mean = 0;
+    for (int s : scores) mean += s;
+    mean /= scores.size();
+    printf("score:  mean %.1f  min %d  p10 %d  p50 %d  p90 %d  p99 %d  max %d\n",
+           mean, scores.front(), pct(0.10), pct(0.50), pct(0.90), pct(0.99), scores.back());
+
+    const int buckets = 10;
+    int lo = scores.front(), hi = scores.back(), width = std::max(1, (hi - lo + buckets) / buckets);
+    std::vector<int> counts(buckets);
+    for (int s : scores) ++counts[std::min(buckets - 1, (s - lo) / width)];
+    int peak = *std::max_element(counts.begin(), counts.end());
+    for (int b = 0; b < buckets; ++b) {
+        printf("  %6d-%-6d %7d ", lo + b * width, lo + (b + 1) * width - 1, counts[b]);
+        for (int k = 0; k < counts[b] * 40 / peak; ++k) putchar('#');
+        putchar('\n');
+    }
+}
+
+static int threadCount(const Options& opt) {
+    return opt.threads > 0 ? opt.threads : (int)std::max(1u, std::thread::hardware_concurrency());
+}
+
+static int runEpisodePool(const Options& opt) {
+    int threads = threadCount(opt);
+    if (!opt.recordDir.empty()) std::filesystem::create_directories(opt.recordDir);
+    std::vector<std::vector<float>> latency(opt.episodes), nearFull(opt.episodes);
+    RunReport report = runEpisodes(opt.episodes, threads, [&](int episode) {
+        SnakeSim sim(opt.width, opt.height, opt.seed, (uint64_t)episode);
+        Bot bot(opt, POLICY_STREAM + episode);
+        ReplayRecorder recorder;
+        bool recording = !opt.recordDir.empty();
+        if (recording) recorder.begin(opt.width, opt.height, opt.seed, (uint64_t)episode, 150);
+        EpisodeResult r;
+        // A recorded episode also ends where the replay would have to
+        long long maxSteps = recording ? std::min(opt.maxSteps, MAX_REPLAY_TICKS) : opt.maxSteps;
+        while (!sim.finished() && sim.ticks() < maxSteps) {
+            sim.step(bot.move(sim));
+            if (recording) recorder.record(sim.direction());
+        }
+        if (recording) {
+            std::string path = opt.recordDir + "/episode_" + std::to_string(episode) + ".snkr";
+            if (!saveReplay(recorder.finish(sim), path)) fprintf(stderr, "failed to write %s\n", path.c_str());
+        }
+        latency[episode].swap(bot.latencyUs);
+        nearFull[episode].swap(bot.nearFullUs);
+        r.steps = sim.ticks();
+        r.score = sim.score();
+        r.boardComplete = sim.boardComplete();
+        r.finished = sim.finished();
+        return r;
+    });
+
+    printf("grid:   %dx%d  policy: %s  seed: %llu  threads: %d\n", opt.width, opt.height,
+           POLICY_NAMES[opt.policy], (unsigned long long)opt.seed, threads);
+    printf("steps:  %lld in %.3f s (%.2f M steps/s)\n", report.totalSteps, report.wallSeconds,
+           report.totalSteps / report.wallSeconds / 1e6);
+    for (size_t w = 0; w < report.workers.size(); ++w) {
+        const WorkerStats& ws = report.workers[w];
+        printf("  worker %2zu: %6lld episodes %12lld steps %5lld steals  util %5.1f%%\n", w, ws.episodes,
+               ws.steps, ws.steals, 100.0 * ws.busySeconds / report.wallSeconds);
+    }
+    std::vector<int> scores;
+    long long wins = 0, finished = 0;
+    for (const auto& e : report.episodes) {
+        scores.push_back(e.score);
+        if (e.boardComplete) ++wins;
+        if (e.finished) ++finished;
+    }
+    printf("games:  %lld finished, %lld board complete, %lld cut off at --max-steps %lld\n", finished, wins,
+           opt.episodes - finished, opt.maxSteps);
+    if (opt.expectComplete)
+        for (size_t e = 0; e < report.episodes.size(); ++e) {
+            const EpisodeResult& r = report.episodes[e];
+            if (!r.boardComplete)
+                printf("INCOMPLETE  episode %zu: score %d, %s after %lld steps\n", e, r.score,
+                       r.finished ? "died" : "cut off", r.steps);
+        }
+    printScoreDistribution(scores);
+    std::vector<float> allLatency, allNearFull;
+    for (int e = 0; e < opt.episodes; ++e) {
+        allLatency.insert(allLatency.end(), latency[e].begin(), latency[e].end());
+        allNearFull.insert(allNearFull.end(), nearFull[e].begin(), nearFull[e].end());
+    }
+    printLatency("decide:", allLatency);
+    printLatency("  >=90%:", allNearFull);
+    return opt.expectComplete && wins < opt.episodes ? 1 : 0;
+}
+
+static int verifyReplays(const Options& opt) {
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(opt.verifyDir, ec))
+        if (entry.path().extension() == ".snkr") files.push_back(entry.path().string());
+    if (ec) { fprintf(stderr, "cannot read %s\n", opt.verifyDir.c_str()); return 1; }
+    std::sort(files.begin(), files.end());
+
+    std::vector<char> ok(files.size());
+    std::vector<long long> sizes(files.size());
+    RunReport report = runEpisodes((int)files.size(), threadCount(opt), [&](int i) {
+        EpisodeResult r;
+        Replay replay;
+        if (!loadReplay(files[i], replay)) return r;
+        sizes[i] = (long long)std::filesystem::file_size(files[i]);
+        ok[i] = verifyReplay(replay);
+        r.steps = replay.ticks;
+        r.score = replay.score;
+        r.boardComplete = replay.boardComplete;
+        return r;
+    });
+
+    int failures = 0;
+    long long bytes = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        bytes += sizes[i];
+        if (!ok[i]) { ++failures; printf("FAIL  %s\n", files[i].c_str()); }
+    }
+    printf("replays: %zu verified, %d failed, %.1f bytes average\n", files.size(), failures,
+           files.empty() ? 0.0 : (double)bytes / files.size());
+    printf("ticks:   %lld re-simulated in %.3f s (%.0f ticks/ms)\n", report.totalSteps, report.wallSeconds,
+           report.totalSteps / (report.wallSeconds * 1000.0));
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) { usage(argv[0]); return 1; }
+    if (!opt.verifyDir.empty()) return verifyReplays(opt);
+    if (opt.episodes > 0) return runEpisodePool(opt);
+
+    RunStats stats;
+    auto start = std::chrono::steady_clock::now();
+    long long ticks = opt.batch > 0 ? runBatch(opt, stats) : runSingle(opt, stats);
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("grid:   %dx%d  policy: %s  seed: %llu", opt.width, opt.height, POLICY_NAMES[opt.policy], (unsigned long long)opt.seed);
+    if (opt.batch > 0) printf("  batch: %d", opt.batch);
+    printf("\n");
+    printf("ticks:  %lld in %.3f s (%.2f M ticks/s)\n", ticks, secs, ticks / secs / 1e6);
+    printf("games:  %lld finished, %lld board complete\n", stats.games, stats.wins);
+    if (stats.games > 0)
+        printf("score:  mean %.1f  best %d\n", (double)stats.scoreSum / stats.games, stats.bestScore);
+    return 0;
+}
@@ -0,0 +1,191 @@
+#include "snake_layer.h"
+
+#include <algorithm>
+
+#include "frame_stats.h"
+#include "gl_program.h"
+
+// Instances 0-3 are the head (glow then disc, for each of two copies),
+// then two per body segment; a copy that is not needed is pushed outside
+// the clip volume. The order matches the immediate-mode path in main.cpp.
+static const char* SNAKE_VERTEX_SHADER = R"(#version 330 core
+layout(location = 0) in vec2 corner;
+uniform isamplerBuffer ring;
+uniform int headSlot, ringSize, gridW, gridH, snakeLength, previousLength, previousTail;
+uniform float alpha, radius;
+uniform vec4 area;  // left, bottom, cell width, cell height
+uniform vec4 headColor, bodyColor;
+out vec2 local;
+out vec4 fillColor;
+flat out float shapeRadius;
+
+ivec2 cellPoint(int c) { return ivec2(c % gridW, c / gridW); }
+
+ivec2 segment(int i) {
+    int slot = headSlot - i;
+    if (slot < 0) slot += ringSize;
+    return cellPoint(texelFetch(ring, slot).r);
+}
+
+void main() {
+    int j = gl_InstanceID, i, copy;
+    bool glow = false;
+    if (j < 4) { i = 0; copy = j / 2; glow = (j % 2) == 0; }
+    else { i = 1 + (j - 4) / 2; copy = (j - 4) % 2; }
+    local = corner;
+    fillColor = i == 0 ? vec4(headColor.rgb, glow ? 0.4 : headColor.a) : bodyColor;
+    float r = glow ? radius * 1.2 : radius;
+    shapeRadius = r;
+
+    ivec2 seg = segment(i);
+    vec2 pos = vec2(seg);
+    if (previousLength > 0 && alpha < 1.0) {
+        ivec2 from = i + 1 < snakeLength ? segment(i + 1)
+                   : (snakeLength > previousLength ? seg : cellPoint(previousTail));
+        ivec2 d = seg - from;
+        if (d.x > 1) d.x -= gridW; else if (d.x < -1) d.x += gridW;
+        if (d.y > 1) d.y -= gridH; else if (d.y < -1) d.y += gridH;
+        pos -= (1.0 - alpha) * vec2(d);
+    }
+    if (copy == 1) {
+        if (pos.x < 0.0) pos.x += float(gridW);
+        else if (pos.x > float(gridW - 1)) pos.x -= float(gridW);
+        else if (pos.y < 0.0) pos.y += float(gridH);
+        else if (pos.y > float(gridH - 1)) pos.y -= float(gridH);
+        else { gl_Position = vec4(0.0, 0.0, 2.0, 1.0); return; }
+    }
+    vec2 centre = area.xy + (pos + 0.5) * area.zw;
+    gl_Position = vec4(centre + corner * r, 0.0, 1.0);
+}
+)";
+
+static const char* SNAKE_FRAGMENT_SHADER = R"(#version 330 core
+in vec2 local;
+in vec4 fillColor;
+flat in float shapeRadius;
+out vec4 fragColor;
+void main() {
+    vec2 pixel = fwidth(local) * shapeRadius;
+    float d = (length(local) - 1.0) * shapeRadius;
+    float coverage = clamp(0.5 - d / max(pixel.x, pixel.y), 0.0, 1.0);
+    if (coverage <= 0.0) discard;
+    fragColor = vec4(fillColor.rgb, fillColor.a * coverage);
+}
+)";
+
+static const int INITIAL_RING_SIZE = 256;
+
+bool SnakeLayer::init(int width, int height) {
+    if (!GLAD_GL_VERSION_3_3) return false;
+    program = buildProgram(SNAKE_VERTEX_SHADER, SNAKE_FRAGMENT_SHADER, "Snake");
+    if (!program) return false;
+    gridW = width, gridH = height, cells = width * height;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxRingSize);
+    ringSize = std::min(INITIAL_RING_SIZE, std::min(cells, maxRingSize));
+    ring.assign(ringSize, 0);
+
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "ring"), 0);
+    glUniform1i(glGetUniformLocation(program, "gridW"), gridW);
+    glUniform1i(glGetUniformLocation(program, "gridH"), gridH);
+    uRingSize = glGetUniformLocation(program, "ringSize");
+    uHeadSlot = glGetUniformLocation(program, "headSlot");
+    uLength = glGetUniformLocation(program, "snakeLength");
+    uPreviousLength = glGetUniformLocation(program, "previousLength");
+    uPreviousTail = glGetUniformLocation(program, "previousTail");
+    uAlpha = glGetUniformLocation(program, "alpha");
+    uArea = glGetUniformLocation(program, "area");
+    uRadius = glGetUniformLocation(program, "radius");
+    uHeadColor = glGetUniformLocation(program, "headColor");
+    uBodyColor = glGetUniformLocation(program, "bodyColor");
+    glUseProgram(0);
+
+    static const float QUAD[8] = {-1, -1, 1, -1, -1, 1, 1, 1};
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &quadVbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(QUAD), QUAD, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glBindVertexArray(0);
+
+    glGenBuffers(1, &ringBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, ringBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, ringSize * sizeof(int32_t), ring.data(), GL_DYNAMIC_DRAW);
+    glGenTextures(1, &ringTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, ringTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32I, ringBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+// Doubles the ring until `length` segments fit, capped by the board and the
+// driver; the next sync uploads the whole body
+bool SnakeLayer::reserve(int length) {
+    if (length <= ringSize) return true;
+    if (length > maxRingSize) return false;
+    int size = ringSize;
+    while (size < length) size *= 2;
+    ringSize = std::min(size, std::min(cells, maxRingSize));
+    ring.assign(ringSize, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, ringBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, ringSize * sizeof(int32_t), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    synced = false;
+    return true;
+}
+
+// Uploads the heads of the ticks since the last draw, or the whole body
+// after a reset or a jump longer than the snake
+void SnakeLayer::sync(const SnakeSim& sim) {
+    long long ticks = sim.ticks();
+    long long behind = ticks - syncedTicks;
+    int len = sim.length();
+    glBindBuffer(GL_TEXTURE_BUFFER, ringBuffer);
+    if (!synced || behind < 0 || behind >= len) {
+        for (int i = 0; i < len; ++i) {
+            Point p = sim.segment(i);
+            ring[(ticks - i) % ringSize] = sim.cellIndex(p.x, p.y);
+        }
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, ringSize * sizeof(int32_t), ring.data());
+    } else {
+        for (long long i = 0; i < behind; ++i) {
+            Point p = sim.segment((int)i);
+            int slot = (int)((ticks - i) % ringSize);
+            ring[slot] = sim.cellIndex(p.x, p.y);
+            glBufferSubData(GL_TEXTURE_BUFFER, slot * sizeof(int32_t), sizeof(int32_t), &ring[slot]);
+        }
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    syncedTicks = ticks;
+    synced = true;
+}
+
+bool SnakeLayer::draw(const SnakeSim& sim, const View& view) {
+    if (!ready() || sim.width() != gridW || sim.height() != gridH || !reserve(sim.length())) return false;
+    sync(sim);
+    int len = sim.length();
+    glUseProgram(program);
+    glUniform1i(uRingSize, ringSize);
+    glUniform1i(uHeadSlot, (int)(sim.ticks() % ringSize));
+    glUniform1i(uLength, len);
+    glUniform1i(uPreviousLength, view.previousLength);
+    glUniform1i(uPreviousTail, sim.cellIndex(view.previousTail.x, view.previousTail.y));
+    glUniform1f(uAlpha, view.alpha);
+    glUniform4f(uArea, view.left, view.bottom, view.cellW, view.cellH);
+    glUniform1f(uRadius, view.radius);
+    glUniform4fv(uHeadColor, 1, view.headColor);
+    glUniform4fv(uBodyColor, 1, view.bodyColor);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, ringTexture);
+    glBindVertexArray(vao);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, 2 * len + 2);
+    drawCounters.add(4 * (2LL * len + 2));
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glUseProgram(0);
+    return true;
+}
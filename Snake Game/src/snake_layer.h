@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "snake_sim.h"
+
+// Draws the snake with its positions resolved on the GPU, so a frame costs
+// the same CPU time at length 1 and at a full board. The cell the head
+// entered on tick t lives in slot t % ringSize of a buffer texture; since
+// every body segment is an earlier head, segment i is slot t - i and a tick
+// uploads one int. The ring doubles whenever the snake outgrows it, so it
+// follows the snake's length rather than the board's. The vertex shader reads
+// the segments, slides them between cells by the tick fraction, adds the
+// second copy half way through a wrapping edge and the head glow, and the
+// fragment shader cuts the disc with a signed distance like ShapeBatch does.
+class SnakeLayer {
+public:
+    // Where and how to draw, in NDC; colours are RGBA
+    struct View {
+        float left, bottom, cellW, cellH, radius;
+        const float* headColor;
+        const float* bodyColor;
+        float alpha;           // fraction of the current tick that has passed
+        Point previousTail;    // tail cell before the last step
+        int previousLength;    // length before the last step, 0 = nothing to blend from
+    };
+
+    // Needs a current GL 3.3 context; returns false when it cannot be set up
+    bool init(int width, int height);
+    bool ready() const { return program != 0; }
+    // The next draw re-uploads the whole body (new game, replay seek)
+    void invalidate() { synced = false; }
+    // False, drawing nothing, when the snake is longer than the largest
+    // buffer texture the driver allows; the caller then draws it on the CPU
+    bool draw(const SnakeSim& sim, const View& view);
+
+private:
+    int gridW = 0, gridH = 0, cells = 0;
+    int ringSize = 0, maxRingSize = 0;
+    GLuint program = 0, vao = 0, quadVbo = 0, ringBuffer = 0, ringTexture = 0;
+    GLint uRingSize = -1, uHeadSlot = -1, uLength = -1, uPreviousLength = -1, uPreviousTail = -1, uAlpha = -1;
+    GLint uArea = -1, uRadius = -1, uHeadColor = -1, uBodyColor = -1;
+    std::vector<int32_t> ring;  // CPU copy of the buffer texture
+    long long syncedTicks = 0;
+    bool synced = false;
+
+    bool reserve(int length);
+    void sync(const SnakeSim& sim);
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+// PCG32 (pcg-random.org, XSH-RR variant): 64-bit state, 32-bit output. The
+// increment selects one of 2^63 independent streams, so every game gets its
+// own generator from (seed, stream) and replays and parallel runs come out
+// bit-exact regardless of how many other games are running.
+struct Pcg32 {
+    uint64_t state = 0x853c49e6748fea9bULL;
+    uint64_t inc = 0xda3e39cb94b95bdbULL;
+
+    Pcg32() {}
+    Pcg32(uint64_t seed, uint64_t stream) { reseed(seed, stream); }
+
+    void reseed(uint64_t seed, uint64_t stream) {
+        state = 0;
+        inc = (stream << 1) | 1;
+        next();
+        state += seed;
+        next();
+    }
+
+    uint32_t next() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + inc;
+        uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+        uint32_t rot = (uint32_t)(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((0u - rot) & 31));
+    }
+
+    // Uniform in [0, bound) without modulo bias (Lemire's multiply-shift;
+    // the division only runs on the rare rejection path)
+    uint32_t below(uint32_t bound) {
+        uint64_t m = (uint64_t)next() * bound;
+        uint32_t low = (uint32_t)m;
+        if (low < bound) {
+            uint32_t threshold = (0u - bound) % bound;
+            while (low < threshold) {
+                m = (uint64_t)next() * bound;
+                low = (uint32_t)m;
+            }
+        }
+        return (uint32_t)(m >> 32);
+    }
+};
@@ -0,0 +1,190 @@
+// Renders a recorded game to a PPM or PNG frame sequence on the CPU: the
+// replay is re-simulated through SnakeSim and every frame is drawn by
+// SoftRaster with the game's own screen layout. No window, GL or display
+// needed, so it runs on headless servers.
+#include "bitmap_font.h"
+#include "frame_dump.h"
+#include "snake_replay.h"
+#include "snake_scene.h"
+#include "snake_sim.h"
+#include "soft_raster.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct Options {
+    std::string replayPath;
+    std::string outDir;      // empty = render only, for timing
+    bool png = false;
+    int width = WIDTH, height = HEIGHT;
+    float zoom = CELL_SIZE;  // cell size in layout pixels; bigger boards follow the head
+    double fps = 0.0;        // frames per second of game time; 0 = one frame per tick
+    long long from = 0, to = -1;  // tick range, -1 = to the end of the replay
+    int threads = 0;         // 0 = one per hardware thread
+    bool checksum = false;   // print a checksum over every frame, to compare runs
+    std::string tracePath;
+};
+
+static void usage(const char* prog) {
+    printf("usage: %s REPLAY [--out DIR] [--format ppm|png] [--size WxH] [--zoom PX] [--fps N]\n"
+           "          [--from TICK] [--to TICK] [--threads T] [--checksum] [--trace FILE]\n", prog);
+}
+
+static bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (!strcmp(a, "--out") && hasValue) opt.outDir = argv[++i];
+        else if (!strcmp(a, "--format") && hasValue) {
+            const char* f = argv[++i];
+            if (!strcmp(f, "png")) opt.png = true;
+            else if (!strcmp(f, "ppm")) opt.png = false;
+            else return false;
+        }
+        else if (!strcmp(a, "--size") && hasValue) {
+            if (sscanf(argv[++i], "%dx%d", &opt.width, &opt.height) != 2) return false;
+        }
+        else if (!strcmp(a, "--zoom") && hasValue) opt.zoom = (float)atof(argv[++i]);
+        else if (!strcmp(a, "--fps") && hasValue) opt.fps = atof(argv[++i]);
+        else if (!strcmp(a, "--from") && hasValue) opt.from = atoll(argv[++i]);
+        else if (!strcmp(a, "--to") && hasValue) opt.to = atoll(argv[++i]);
+        else if (!strcmp(a, "--threads") && hasValue) opt.threads = atoi(argv[++i]);
+        else if (!strcmp(a, "--checksum")) opt.checksum = true;
+        else if (!strcmp(a, "--trace") && hasValue) opt.tracePath = argv[++i];
+        else if (a[0] != '-' && opt.replayPath.empty()) opt.replayPath = a;
+        else return false;
+    }
+    return !opt.replayPath.empty() && opt.width > 0 && opt.height > 0 && opt.fps >= 0.0
+        && opt.zoom >= MIN_CELL_PIXELS && opt.zoom <= MAX_CELL_PIXELS
+        && opt.from >= 0 && opt.threads >= 0;
+}
+
+static const char* difficultyName(int tickMillis) {
+    switch (tickMillis) {
+        case 250: return "EASY";
+        case 150: return "MEDIUM";
+        case 80: return "HARD";
+        default: return "CUSTOM";
+    }
+}
+
+// The playing screen as the game shows it during replay playback. Like the
+// game's HUD layer, the panels are drawn once and copied back in until the
+// score or length they show changes.
+struct HudCache {
+    std::vector<uint32_t> pixels;
+    int score = -1, length = -1;
+};
+
+static void renderFrame(SoftRaster& raster, HudCache& cache, const Camera& camera, std::vector<int>& visible,
+                        const SnakeSim& sim, const HudInfo& hud, float tickAlpha, Point previousTail, int previousLength) {
+    TRACE_SCOPE("renderFrame");
+    raster.clearClip();
+    if (hud.score != cache.score || hud.length != cache.length) {
+        scene::hud(raster, hud);
+        raster.flush();
+        raster.copyTo(cache.pixels);
+        cache.score = hud.score;
+        cache.length = hud.length;
+    } else raster.copyFrom(cache.pixels);
+    // Food and snake are clipped to the game area like the GL scissor does
+    raster.setClip(0, scene::boardClipY(raster.height()), raster.width(), scene::boardClipHeight(raster.height()));
+    float headX, headY;
+    scene::segmentPosition(sim, 0, tickAlpha, previousTail, previousLength, headX, headY);
+    BoardView board = camera.view(sim, headX, headY);
+    scene::food(raster, sim, board);
+    scene::snake(raster, sim, board, tickAlpha, previousTail, previousLength, visible);
+    raster.flush();
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) { usage(argv[0]); return 1; }
+    trace::setThreadName("main");
+    Replay replay;
+    if (!loadReplay(opt.replayPath, replay)) { fprintf(stderr, "cannot read replay %s\n", opt.replayPath.c_str()); return 1; }
+    long long lastTick = opt.to < 0 ? replay.ticks : std::min(opt.to, replay.ticks);
+    if (opt.from > lastTick) { fprintf(stderr, "--from is past the end of the replay (%lld ticks)\n", replay.ticks); return 1; }
+    if (!opt.outDir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(opt.outDir, ec);
+        if (ec) { fprintf(stderr, "cannot create %s\n", opt.outDir.c_str()); return 1; }
+    }
+
+    SnakeSim sim(replay.width, replay.height);
+    ReplayPlayer player(replay, sim);
+    SoftRaster raster(opt.threads);
+    HudCache hudCache;
+    Camera camera;
+    camera.cellPixels = opt.zoom;
+    std::vector<int> visibleSegments;
+    raster.resize(opt.width, opt.height);
+    raster.setGlyphs(&FONT.glyphs[0].rows[0]);
+
+    // Same bookkeeping as the game's updateSnake(), for the in-between frames
+    Point previousTail = sim.segment(sim.length() - 1);
+    int previousLength = 0;
+    auto stepTo = [&](long long tick) {
+        TRACE_SCOPE("simulate");
+        while (player.tick() < tick && !player.atEnd()) {
+            previousTail = sim.segment(sim.length() - 1);
+            previousLength = sim.length();
+            player.stepOne();
+        }
+    };
+
+    // Frame k shows game time `from + k * ticksPerFrame` ticks: the state
+    // after that whole tick, `tickAlpha` of the way from the one before
+    double ticksPerFrame = opt.fps > 0.0 ? 1000.0 / (replay.tickMillis * opt.fps) : 1.0;
+    long long frames = (long long)((lastTick - opt.from) / ticksPerFrame) + 1;
+    double renderSeconds = 0.0, writeSeconds = 0.0;
+    uint64_t sequenceChecksum = 0xcbf29ce484222325ULL;
+    auto start = std::chrono::steady_clock::now();
+    for (long long k = 0; k < frames; ++k) {
+        double t = opt.from + k * ticksPerFrame;
+        long long tick = (long long)t;
+        float tickAlpha = opt.fps > 0.0 ? (float)(t - tick) : 1.0f;
+        if (tickAlpha <= 0.0f) tickAlpha = 1.0f;  // on a tick boundary the step has fully landed
+        stepTo(tick);
+
+        auto renderStart = std::chrono::steady_clock::now();
+        HudInfo hud = {sim.score(), sim.length(), difficultyName(replay.tickMillis), "REPLAY: LEFT RIGHT - SEEK"};
+        renderFrame(raster, hudCache, camera, visibleSegments, sim, hud, tickAlpha, previousTail, previousLength);
+        auto renderEnd = std::chrono::steady_clock::now();
+        renderSeconds += std::chrono::duration<double>(renderEnd - renderStart).count();
+
+        if (opt.checksum)
+            sequenceChecksum = (sequenceChecksum ^ frameChecksum(opt.width, opt.height, raster.pixels())) * 0x100000001b3ULL;
+        if (!opt.outDir.empty()) {
+            TRACE_SCOPE("writeFrame");
+            char name[32];
+            snprintf(name, sizeof(name), "frame_%06lld.%s", k, opt.png ? "png" : "ppm");
+            std::string path = opt.outDir + "/" + name;
+            bool ok = opt.png ? writePng(path, opt.width, opt.height, raster.pixels())
+                              : writePpm(path, opt.width, opt.height, raster.pixels());
+            if (!ok) { fprintf(stderr, "failed to write %s\n", path.c_str()); return 1; }
+            writeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - renderEnd).count();
+        }
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double gameSeconds = (lastTick - opt.from) * replay.tickMillis / 1000.0;
+
+    printf("replay:   %dx%d board, %lld ticks at %d ms, score %d\n", replay.width, replay.height, replay.ticks,
+           replay.tickMillis, replay.score);
+    printf("frames:   %lld at %dx%d on %d threads in %.3f s (%.1f frames/s, %.0fx real time)\n", frames, opt.width,
+           opt.height, raster.threads(), secs, frames / secs, secs > 0.0 ? gameSeconds / secs : 0.0);
+    printf("per frame: render %.3f ms", 1000.0 * renderSeconds / frames);
+    if (!opt.outDir.empty()) printf("  write %.3f ms (%s)", 1000.0 * writeSeconds / frames, opt.png ? "png" : "ppm");
+    printf("\n");
+    if (opt.checksum) printf("checksum: %016llx\n", (unsigned long long)sequenceChecksum);
+    if (!opt.tracePath.empty() && !trace::write(opt.tracePath.c_str()))
+        fprintf(stderr, "failed to write %s (tracing needs a build with -DENABLE_TRACE=ON)\n", opt.tracePath.c_str());
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include "snake_replay.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+static const char REPLAY_MAGIC[4] = {'S', 'N', 'K', 'R'};
+static const uint8_t REPLAY_VERSION = 1;
+
+static void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back((uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((uint8_t)v);
+}
+
+static bool getVarint(const std::vector<uint8_t>& in, size_t& pos, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= in.size()) return false;
+        uint8_t b = in[pos++];
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+// ---- Recording ----
+void ReplayRecorder::begin(int width, int height, uint64_t seed, uint64_t stream, int tickMillis) {
+    replay = Replay();
+    replay.width = width;
+    replay.height = height;
+    replay.seed = seed;
+    replay.stream = stream;
+    replay.tickMillis = tickMillis;
+    last = RIGHT;
+    tick = lastEventTick = 0;
+    recording = true;
+}
+
+void ReplayRecorder::record(Direction applied) {
+    if (!recording || tick >= MAX_REPLAY_TICKS) return;
+    ++tick;
+    if (applied == last) return;
+    putVarint(replay.events, (uint64_t)(tick - lastEventTick) << 2 | applied);
+    lastEventTick = tick;
+    last = applied;
+}
+
+const Replay& ReplayRecorder::finish(const SnakeSim& sim) {
+    replay.ticks = sim.ticks();
+    replay.score = sim.score();
+    replay.length = sim.length();
+    replay.boardComplete = sim.boardComplete();
+    recording = false;
+    return replay;
+}
+
+// ---- Playback ----
+ReplayPlayer::ReplayPlayer(const Replay& replay, SnakeSim& target) : rep(replay), sim(target) {
+    restart();
+}
+
+void ReplayPlayer::restart() {
+    sim.reset(rep.seed, rep.stream);
+    cursor = 0;
+    nextEventTick = 0;
+    current = RIGHT;
+    readEvent();
+}
+
+void ReplayPlayer::readEvent() {
+    uint64_t v;
+    if (!getVarint(rep.events, cursor, v)) { nextEventTick = -1; return; }
+    nextEventTick += (long long)(v >> 2);
+    nextEventDir = (Direction)(v & 3);
+}
+
+bool ReplayPlayer::stepOne() {
+    if (atEnd()) return false;
+    if (sim.ticks() + 1 == nextEventTick) {
+        current = nextEventDir;
+        readEvent();
+    }
+    sim.step(current);
+    return true;
+}
+
+void ReplayPlayer::seek(long long target) {
+    if (target < tick()) restart();
+    while (tick() < target && stepOne()) {}
+}
+
+// ---- Files ----
+bool saveReplay(const Replay& r, const std::string& path) {
+    std::vector<uint8_t> out(REPLAY_MAGIC, REPLAY_MAGIC + 4);
+    out.push_back(REPLAY_VERSION);
+    putVarint(out, r.width);
+    putVarint(out, r.height);
+    for (int i = 0; i < 8; ++i) out.push_back((uint8_t)(r.seed >> (8 * i)));
+    putVarint(out, r.stream);
+    putVarint(out, r.tickMillis);
+    putVarint(out, r.ticks);
+    putVarint(out, r.score);
+    putVarint(out, r.length);
+    out.push_back(r.boardComplete ? 1 : 0);
+    putVarint(out, r.events.size());
+    out.insert(out.end(), r.events.begin(), r.events.end());
+
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f) return false;
+    f.write((const char*)out.data(), out.size());
+    return (bool)f;
+}
+
+bool loadReplay(const std::string& path, Replay& r) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    std::vector<uint8_t> in((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    if (in.size() < 5 + 8 || !std::equal(REPLAY_MAGIC, REPLAY_MAGIC + 4, in.begin()) || in[4] != REPLAY_VERSION)
+        return false;
+
+    size_t pos = 5;
+    uint64_t w, h, stream, tickMillis, ticks, score, length, eventBytes;
+    if (!getVarint(in, pos, w) || !getVarint(in, pos, h)) return false;
+    if (w < 2 || h < 2 || w > MAX_GRID_SIDE || h > MAX_GRID_SIDE || pos + 8 > in.size()) return false;
+    uint64_t seed = 0;
+    for (int i = 0; i < 8; ++i) seed |= (uint64_t)in[pos++] << (8 * i);
+    if (!getVarint(in, pos, stream) || !getVarint(in, pos, tickMillis) || !getVarint(in, pos, ticks) ||
+        !getVarint(in, pos, score) || !getVarint(in, pos, length) || pos >= in.size() ||
+        ticks > (uint64_t)MAX_REPLAY_TICKS)
+        return false;
+    bool complete = in[pos++] != 0;
+    if (!getVarint(in, pos, eventBytes) || eventBytes != in.size() - pos) return false;
+
+    r = Replay();
+    r.width = (int)w;
+    r.height = (int)h;
+    r.seed = seed;
+    r.stream = stream;
+    r.tickMillis = (int)tickMillis;
+    r.ticks = (long long)ticks;
+    r.score = (int)score;
+    r.length = (int)length;
+    r.boardComplete = complete;
+    r.events.assign(in.begin() + pos, in.end());
+    return true;
+}
+
+bool verifyReplay(const Replay& r) {
+    SnakeSim sim(r.width, r.height);
+    ReplayPlayer player(r, sim);
+    player.seek(r.ticks);
+    return sim.ticks() == r.ticks && sim.score() == r.score &&
+           sim.length() == r.length && sim.boardComplete() == r.boardComplete;
+}
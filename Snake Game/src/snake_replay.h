@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "snake_sim.h"
+
+// A game is fully determined by its board size, its food seed/stream and the
+// direction applied on every tick, so a replay stores only those plus the
+// final result for verification. Direction changes are packed as LEB128
+// varints of (ticks since previous change << 2 | direction): a run of ticks
+// without a turn costs nothing and a turn usually costs one byte.
+//
+// File layout (all integers LEB128 unless noted):
+//   "SNKR" magic, u8 version
+//   width, height, seed (u64 little-endian), stream, tick interval in ms
+//   ticks, score, length, u8 board complete
+//   event byte count, event bytes
+// Longest recording, about 93 days of play at the 80 ms HARD tick. The
+// recorder stops here and loading refuses more, so verifying or playing
+// back any file re-simulates at most this many ticks.
+const long long MAX_REPLAY_TICKS = 100000000;
+
+struct Replay {
+    int width = 0, height = 0;
+    uint64_t seed = 0, stream = 0;
+    int tickMillis = 150;
+
+    long long ticks = 0;
+    int score = 0;
+    int length = 0;
+    bool boardComplete = false;
+
+    std::vector<uint8_t> events;
+};
+
+class ReplayRecorder {
+public:
+    void begin(int width, int height, uint64_t seed, uint64_t stream, int tickMillis);
+    // Call after every SnakeSim::step() with the direction it applied;
+    // ignored once MAX_REPLAY_TICKS have been recorded
+    void record(Direction applied);
+    // MAX_REPLAY_TICKS recorded: finish() now, before the sim moves on
+    bool full() const { return tick >= MAX_REPLAY_TICKS; }
+    // Stamps the final result of `sim` and returns the finished replay
+    const Replay& finish(const SnakeSim& sim);
+    bool active() const { return recording; }
+
+private:
+    Replay replay;
+    Direction last = RIGHT;
+    long long tick = 0, lastEventTick = 0;
+    bool recording = false;
+};
+
+// Re-simulates a replay through the normal SnakeSim rules
+class ReplayPlayer {
+public:
+    // Plays into `target`, which must have the replay's board size; `replay`
+    // must outlive the player
+    ReplayPlayer(const Replay& replay, SnakeSim& target);
+
+    void restart();
+    // One tick; returns false once the recording is exhausted
+    bool stepOne();
+    // Fast-forwards to `tick`, restarting from the beginning when seeking backwards
+    void seek(long long tick);
+
+    long long tick() const { return sim.ticks(); }
+    bool atEnd() const { return tick() >= rep.ticks || sim.finished(); }
+    const Replay& replay() const { return rep; }
+
+private:
+    const Replay& rep;
+    SnakeSim& sim;
+    size_t cursor = 0;
+    long long nextEventTick = -1;
+    Direction nextEventDir = RIGHT;
+    Direction current = RIGHT;
+
+    void readEvent();
+};
+
+bool saveReplay(const Replay& replay, const std::string& path);
+// Fails on a malformed file or one longer than MAX_REPLAY_TICKS
+bool loadReplay(const std::string& path, Replay& out);
+
+// True when re-simulating reproduces the recorded tick count, score and length
+bool verifyReplay(const Replay& replay);
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "snake_sim.h"
+
+// Layout, colours and drawing of the game screen, shared by the GL game and
+// the CPU renderer. The draw functions take any canvas with ShapeBatch's
+// circle / square / rect / roundedRect / gradient / glyph calls in NDC:
+// ShapeBatch itself, or SoftRaster. Screen-space clipping of the board is
+// left to the caller.
+
+// Window and layout constants
+const int WIDTH = 1000;
+const int HEIGHT = 800;
+const int TOP_UI_HEIGHT_PIXELS = 80;
+const int BOTTOM_UI_HEIGHT_PIXELS = 80;
+const float TOP_UI_HEIGHT_NDC = (float)TOP_UI_HEIGHT_PIXELS / HEIGHT * 2.0f;
+const float BOTTOM_UI_HEIGHT_NDC = (float)BOTTOM_UI_HEIGHT_PIXELS / HEIGHT * 2.0f;
+const float GAME_AREA_TOP_NDC = 1.0f - TOP_UI_HEIGHT_NDC;
+const float GAME_AREA_BOTTOM_NDC = -1.0f + BOTTOM_UI_HEIGHT_NDC;
+const float GAME_AREA_LEFT_NDC = -1.0f;
+const float GAME_AREA_RIGHT_NDC = 1.0f;
+const int GAME_AREA_PIXEL_WIDTH = WIDTH;
+const int GAME_AREA_PIXEL_HEIGHT = HEIGHT - TOP_UI_HEIGHT_PIXELS - BOTTOM_UI_HEIGHT_PIXELS;
+// Cell size in layout pixels (of WIDTH x HEIGHT) at the default zoom; the
+// default board is exactly the game area at this size
+const int CELL_SIZE = 20;
+const float MIN_CELL_PIXELS = CELL_SIZE / 8.0f;
+const float MAX_CELL_PIXELS = CELL_SIZE * 4.0f;
+
+struct Color { float r, g, b, a; };
+
+const Color BG_COLOR        = {0.08f, 0.12f, 0.16f, 1.0f};
+const Color SNAKE_HEAD_COLOR= {0.5f, 0.4f, 0.3f, 1.0f};
+const Color SNAKE_BODY_COLOR= {0.15f, 0.5f, 0.25f, 1.0f};
+const Color FOOD_COLOR      = {1.0f, 1.0f, 1.0f, 1.0f};
+const Color UI_COLOR        = {0.1f, 0.2f, 0.3f, 0.9f};
+const Color TEXT_COLOR      = {0.85f, 0.9f, 1.0f, 1.0f};
+const Color ACCENT_COLOR    = {0.4f, 0.75f, 1.0f, 1.0f};
+const Color GAME_BORDER_COLOR = {0.15f, 0.3f, 0.5f, 1.0f};
+
+const char* const STUDENT_NAME = "TIJUL KABIR TOHA";
+const char* const STUDENT_ID = "240113";
+
+// What the panels around the board show
+struct HudInfo {
+    int score, length;
+    const char* difficulty;
+    const char* controls;  // first line of the bottom panel
+};
+
+// Where the board sits on screen: NDC of the bottom left corner of cell
+// (0, 0) and of one cell's size, and the cells [x0, x1) x [y0, y1) that can
+// show in the game area. The range keeps a cell of margin for segments
+// sliding in from outside and may run one past a board edge, meaning the
+// cells wrapped round from the other side.
+struct BoardView {
+    float left, bottom, cellWidth, cellHeight, radius;
+    int x0, y0, x1, y1;
+    bool whole;  // every cell is on screen
+};
+
+// Zoom and scroll for boards bigger than the game area. Cells are
+// `cellPixels` layout pixels across; when the whole board fits at that size
+// it is stretched over the game area as it always was, otherwise the view
+// centres on the focus (the head) and stops at the board edges. In a
+// direction where the board fits it stays centred.
+struct Camera {
+    float cellPixels = CELL_SIZE;
+
+    void zoom(float factor) { cellPixels = std::min(MAX_CELL_PIXELS, std::max(MIN_CELL_PIXELS, cellPixels * factor)); }
+    bool fits(const SnakeSim& sim) const {
+        return sim.width() * cellPixels <= GAME_AREA_PIXEL_WIDTH && sim.height() * cellPixels <= GAME_AREA_PIXEL_HEIGHT;
+    }
+    BoardView view(const SnakeSim& sim, float focusX, float focusY) const;
+};
+
+inline BoardView Camera::view(const SnakeSim& sim, float focusX, float focusY) const {
+    const int gridWidth = sim.width(), gridHeight = sim.height();
+    BoardView v;
+    if (fits(sim)) {
+        v.left = GAME_AREA_LEFT_NDC, v.bottom = GAME_AREA_BOTTOM_NDC;
+        v.cellWidth = (GAME_AREA_RIGHT_NDC-GAME_AREA_LEFT_NDC)/gridWidth;
+        v.cellHeight = (GAME_AREA_TOP_NDC-GAME_AREA_BOTTOM_NDC)/gridHeight;
+        v.radius = v.cellWidth*0.48f;
+        v.x0 = 0, v.y0 = 0, v.x1 = gridWidth, v.y1 = gridHeight;
+        v.whole = true;
+        return v;
+    }
+    // Board position (in cells) at the middle of the game area
+    float halfW = GAME_AREA_PIXEL_WIDTH / cellPixels / 2.0f, halfH = GAME_AREA_PIXEL_HEIGHT / cellPixels / 2.0f;
+    float centreX = gridWidth <= 2.0f*halfW ? gridWidth / 2.0f : std::min(std::max(focusX + 0.5f, halfW), gridWidth - halfW);
+    float centreY = gridHeight <= 2.0f*halfH ? gridHeight / 2.0f : std::min(std::max(focusY + 0.5f, halfH), gridHeight - halfH);
+    v.cellWidth = cellPixels * 2.0f / WIDTH, v.cellHeight = cellPixels * 2.0f / HEIGHT;
+    v.left = (GAME_AREA_LEFT_NDC+GAME_AREA_RIGHT_NDC)/2.0f - centreX*v.cellWidth;
+    v.bottom = (GAME_AREA_BOTTOM_NDC+GAME_AREA_TOP_NDC)/2.0f - centreY*v.cellHeight;
+    v.radius = v.cellWidth*0.48f;
+    v.x0 = (int)std::floor(centreX - halfW) - 1, v.x1 = (int)std::ceil(centreX + halfW) + 1;
+    v.y0 = (int)std::floor(centreY - halfH) - 1, v.y1 = (int)std::ceil(centreY + halfH) + 1;
+    if (v.x1 - v.x0 >= gridWidth) v.x0 = 0, v.x1 = gridWidth;
+    if (v.y1 - v.y0 >= gridHeight) v.y0 = 0, v.y1 = gridHeight;
+    v.whole = v.x0 == 0 && v.x1 == gridWidth && v.y0 == 0 && v.y1 == gridHeight;
+    return v;
+}
+
+namespace scene {
+
+// Pixel rows (bottom up) of the board inside a framebuffer `height` pixels
+// tall, for the scissor/clip rectangle
+inline int boardClipY(int height) { return (int)(height * (GAME_AREA_BOTTOM_NDC + 1.0f) / 2.0f); }
+inline int boardClipHeight(int height) { return (int)(height * (GAME_AREA_TOP_NDC - GAME_AREA_BOTTOM_NDC) / 2.0f + 0.5f); }
+
+template <class Canvas>
+void background(Canvas& canvas) {
+    const float top[4] = {BG_COLOR.r * 1.2f, BG_COLOR.g * 1.2f, BG_COLOR.b * 1.2f, BG_COLOR.a};
+    const float bottom[4] = {BG_COLOR.r, BG_COLOR.g, BG_COLOR.b, BG_COLOR.a};
+    canvas.gradient(0.0f, 0.0f, 1.0f, 1.0f, top, bottom);
+}
+
+template <class Canvas>
+void roundedRect(Canvas& canvas, float x, float y, float width, float height, float radius, Color color) {
+    canvas.roundedRect(x + width / 2, y + height / 2, width / 2, height / 2, radius, color.r, color.g, color.b, color.a);
+}
+
+// One glyph per character; the top row of the glyphs sits at y
+template <class Canvas>
+void text(Canvas& canvas, float x, float y, const char* text, float size, Color color) {
+    float curX = x;
+    float charWidth = size * 0.7f, charHeight = size;
+    float centreY = y + charHeight / 7.0f - charHeight / 2.0f;
+    for (const char* p = text; *p; ++p) {
+        unsigned char c = *p;
+        if (c == ' ') { curX += charWidth; continue; }
+        canvas.glyph(curX + charWidth / 2, centreY, charWidth / 2, charHeight / 2, c, color.r, color.g, color.b, color.a);
+        curX += charWidth + size * 0.1f;
+    }
+}
+
+// Background, top and bottom panels and the board border
+template <class Canvas>
+void hud(Canvas& canvas, const HudInfo& info) {
+    background(canvas);
+    // Top UI panel
+    roundedRect(canvas, -1.0f, 1.0f-TOP_UI_HEIGHT_NDC, 2.0f, TOP_UI_HEIGHT_NDC, 0.02f, Color{UI_COLOR.r, UI_COLOR.g, UI_COLOR.b, 0.9f});
+    float topPanelCenterY = 1.0f-(TOP_UI_HEIGHT_NDC/2.0f), textLineOffset = 0.02f;
+    text(canvas, -0.95f, topPanelCenterY+textLineOffset, "SCORE", 0.03f, ACCENT_COLOR);
+    char buf[32]; snprintf(buf, sizeof(buf), "%d", info.score);
+    text(canvas, -0.95f, topPanelCenterY-textLineOffset, buf, 0.04f, TEXT_COLOR);
+    const char* diffHeading = "DIFFICULTY";
+    float diffHeadingWidth = strlen(diffHeading)*0.03f*0.7f;
+    text(canvas, -diffHeadingWidth/2, topPanelCenterY+textLineOffset, diffHeading, 0.03f, ACCENT_COLOR);
+    float diffValueTextWidth = strlen(info.difficulty)*0.04f*0.7f;
+    text(canvas, -diffValueTextWidth/2, topPanelCenterY-textLineOffset, info.difficulty, 0.04f, TEXT_COLOR);
+    float studentTextSize=0.025f, studentLineHeight=studentTextSize*1.2f, studentInfoBlockTopY=topPanelCenterY+(studentLineHeight/2.0f);
+    float nameTextWidth = strlen(STUDENT_NAME)*studentTextSize*0.7f;
+    text(canvas, 0.95f-nameTextWidth, studentInfoBlockTopY-(studentTextSize*0.5f), STUDENT_NAME, studentTextSize, TEXT_COLOR);
+    char idText[32]; snprintf(idText, sizeof(idText), "ID: %s", STUDENT_ID);
+    float idTextWidth = strlen(idText)*studentTextSize*0.7f;
+    text(canvas, 0.95f-idTextWidth, studentInfoBlockTopY-studentLineHeight-(studentTextSize*0.5f), idText, studentTextSize, TEXT_COLOR);
+
+    // Bottom UI panel
+    roundedRect(canvas, -1.0f, -1.0f, 2.0f, BOTTOM_UI_HEIGHT_NDC, 0.02f, Color{UI_COLOR.r, UI_COLOR.g, UI_COLOR.b, 0.9f});
+    float bottomPanelCenterY = -1.0f+(BOTTOM_UI_HEIGHT_NDC/2.0f);
+    text(canvas, -0.95f, bottomPanelCenterY+textLineOffset, info.controls, 0.03f, ACCENT_COLOR);
+    text(canvas, -0.95f, bottomPanelCenterY-textLineOffset, "ESC - PAUSE/MENU", 0.03f, ACCENT_COLOR);
+    const char* lengthHeading = "LENGTH";
+    float lengthHeadingWidth = strlen(lengthHeading)*0.03f*0.7f;
+    text(canvas, 0.95f-lengthHeadingWidth, bottomPanelCenterY+textLineOffset, lengthHeading, 0.03f, ACCENT_COLOR);
+    snprintf(buf, sizeof(buf), "%d", info.length);
+    float lengthValueTextWidth = strlen(buf)*0.04f*0.7f;
+    text(canvas, 0.95f-lengthValueTextWidth, bottomPanelCenterY-textLineOffset, buf, 0.04f, TEXT_COLOR);
+
+    // Game area border
+    float borderThicknessNDC_X = (float)2/WIDTH*2.0f, borderThicknessNDC_Y=(float)2/HEIGHT*2.0f;
+    roundedRect(canvas, GAME_AREA_LEFT_NDC-borderThicknessNDC_X, GAME_AREA_BOTTOM_NDC-borderThicknessNDC_Y,
+        (GAME_AREA_RIGHT_NDC-GAME_AREA_LEFT_NDC)+2*borderThicknessNDC_X, (GAME_AREA_TOP_NDC-GAME_AREA_BOTTOM_NDC)+2*borderThicknessNDC_Y,
+        0.03f, Color{GAME_BORDER_COLOR.r, GAME_BORDER_COLOR.g, GAME_BORDER_COLOR.b, 0.5f});
+}
+
+// Where segment i is drawn, in cells, `tickAlpha` of the way from where it
+// was before the last step. Each segment moved into the cell the one behind
+// it now holds; the tail came from previousTail, or stayed put if the snake
+// grew.
+inline void segmentPosition(const SnakeSim& sim, int i, float tickAlpha, Point previousTail, int previousLength,
+                            float& segX, float& segY) {
+    int len = sim.length();
+    Point seg = sim.segment(i);
+    segX = (float)seg.x, segY = (float)seg.y;
+    if (previousLength > 0 && tickAlpha < 1.0f) {
+        Point from = (i+1 < len) ? sim.segment(i+1) : (len > previousLength ? seg : previousTail);
+        int dx = seg.x-from.x, dy = seg.y-from.y;
+        if (dx > 1) dx -= sim.width(); else if (dx < -1) dx += sim.width();  // stepped across a wrapping edge
+        if (dy > 1) dy -= sim.height(); else if (dy < -1) dy += sim.height();
+        segX -= (1.0f-tickAlpha)*dx, segY -= (1.0f-tickAlpha)*dy;
+    }
+}
+
+// Segments on the view's cells, in index order (the order the whole snake
+// is drawn in, so overlapping glows blend the same). The board's 16 x 16
+// tiles are visited and only the ones holding part of the snake are
+// scanned, so the cost follows what is on screen, not the snake's length.
+inline void visibleSegments(const SnakeSim& sim, const BoardView& view, std::vector<int>& out) {
+    out.clear();
+    const int T = SnakeSim::TILE;
+    Point head = sim.head();
+    // A range running past an edge is split into the runs either side of it
+    auto runs = [](int a, int b, int size, int* starts, int* ends) {
+        int n = 0;
+        if (a < 0) starts[n] = a + size, ends[n++] = size, a = 0;
+        if (b > size) starts[n] = 0, ends[n++] = b - size, b = size;
+        starts[n] = a, ends[n++] = b;
+        return n;
+    };
+    int xs[3], xe[3], ys[3], ye[3];
+    int xRuns = runs(view.x0, view.x1, sim.width(), xs, xe), yRuns = runs(view.y0, view.y1, sim.height(), ys, ye);
+    for (int ry = 0; ry < yRuns; ++ry)
+        for (int rx = 0; rx < xRuns; ++rx)
+            for (int ty = ys[ry] / T; ty * T < ye[ry]; ++ty)
+                for (int tx = xs[rx] / T; tx * T < xe[rx]; ++tx) {
+                    if (sim.tileCount(tx, ty) == 0) continue;
+                    int cx0 = std::max(tx * T, xs[rx]), cx1 = std::min(tx * T + T, xe[rx]);
+                    int cy0 = std::max(ty * T, ys[ry]), cy1 = std::min(ty * T + T, ye[ry]);
+                    for (int y = cy0; y < cy1; ++y)
+                        for (int x = cx0; x < cx1; ++x) {
+                            int i = sim.segmentAt(x, y);
+                            if (i < 0) continue;
+                            out.push_back(i);
+                            if (i != 0 && x == head.x && y == head.y) out.push_back(0);  // crashed into segment i
+                        }
+                }
+    std::sort(out.begin(), out.end());
+}
+
+template <class Canvas>
+void food(Canvas& canvas, const SnakeSim& sim, const BoardView& view) {
+    if (!sim.hasFood()) return;
+    Point food = sim.food();
+    float foodX = view.left+(food.x+0.5f)*view.cellWidth, foodY = view.bottom+(food.y+0.5f)*view.cellHeight;
+    float foodHalfSize = view.cellWidth*0.45f;
+    canvas.square(foodX, foodY, foodHalfSize*1.2f, FOOD_COLOR.r, FOOD_COLOR.g, FOOD_COLOR.b, 0.3f);
+    canvas.square(foodX, foodY, foodHalfSize, FOOD_COLOR.r, FOOD_COLOR.g, FOOD_COLOR.b, FOOD_COLOR.a);
+}
+
+// Segment i as a circle, with the head's glow under it
+template <class Canvas>
+void snakeSegment(Canvas& canvas, const SnakeSim& sim, const BoardView& view, int i, float tickAlpha,
+                  Point previousTail, int previousLength) {
+    const int gridWidth = sim.width(), gridHeight = sim.height();
+    float segX, segY;
+    segmentPosition(sim, i, tickAlpha, previousTail, previousLength, segX, segY);
+    // Half way through a wrap the segment shows at both edges
+    int copies = 1;
+    float copyX[2] = {segX, segX}, copyY[2] = {segY, segY};
+    if (segX < 0.0f) copyX[copies++] = segX+gridWidth;
+    else if (segX > gridWidth-1) copyX[copies++] = segX-gridWidth;
+    else if (segY < 0.0f) copyY[copies++] = segY+gridHeight;
+    else if (segY > gridHeight-1) copyY[copies++] = segY-gridHeight;
+    const Color& c = (i==0) ? SNAKE_HEAD_COLOR : SNAKE_BODY_COLOR;
+    for (int k=0;k<copies;k++) {
+        float snakeX = view.left+(copyX[k]+0.5f)*view.cellWidth, snakeY = view.bottom+(copyY[k]+0.5f)*view.cellHeight;
+        if (i==0) canvas.circle(snakeX, snakeY, view.radius*1.2f, c.r, c.g, c.b, 0.4f);
+        canvas.circle(snakeX, snakeY, view.radius, c.r, c.g, c.b, c.a);
+    }
+}
+
+// The whole snake when the whole board shows, otherwise only the segments
+// in the view (found with `visible` as scratch)
+template <class Canvas>
+void snake(Canvas& canvas, const SnakeSim& sim, const BoardView& view, float tickAlpha, Point previousTail,
+           int previousLength, std::vector<int>& visible) {
+    if (view.whole) {
+        for (int i=0;i<sim.length();i++) snakeSegment(canvas, sim, view, i, tickAlpha, previousTail, previousLength);
+        return;
+    }
+    visibleSegments(sim, view, visible);
+    for (int i : visible) snakeSegment(canvas, sim, view, i, tickAlpha, previousTail, previousLength);
+}
+
+}  // namespace scene
@@ -0,0 +1,116 @@
+#include "snake_sim.h"
+
+#include <algorithm>
+
+static const int INITIAL_BODY_SLOTS = 64;
+
+SnakeSim::SnakeSim(int width, int height, uint64_t seed, uint64_t stream)
+    : gridW(width), gridH(height), body(INITIAL_BODY_SLOTS),
+      freeCells(width * height), freeSlot(width * height),
+      tileCols((width + TILE - 1) / TILE), tileSegments(tileCols * ((height + TILE - 1) / TILE)),
+      rng(seed, stream) {
+    reset();
+}
+
+void SnakeSim::reset(uint64_t seed, uint64_t stream) {
+    rng.reseed(seed, stream);
+    reset();
+}
+
+void SnakeSim::reset() {
+    int cells = cellCount();
+    for (int c = 0; c < cells; ++c) freeCells[c] = freeSlot[c] = c;
+    freeCount = cells;
+    std::fill(tileSegments.begin(), tileSegments.end(), 0);
+    headSlot = 0;
+    bodyLen = 1;
+    body[0] = cellIndex(gridW / 2, gridH / 2);
+    occupyCell(body[0], 0);
+    dir = RIGHT;
+    points = 0;
+    tickCount = 0;
+    over = false;
+    placeFood();
+}
+
+Point SnakeSim::neighbor(Point p, Direction d) const {
+    switch (d) {
+        case UP:    p.y += 1; break;
+        case DOWN:  p.y -= 1; break;
+        case LEFT:  p.x -= 1; break;
+        case RIGHT: p.x += 1; break;
+    }
+    if (p.x < 0) p.x = gridW - 1;
+    else if (p.x >= gridW) p.x = 0;
+    if (p.y < 0) p.y = gridH - 1;
+    else if (p.y >= gridH) p.y = 0;
+    return p;
+}
+
+// Doubles the body buffer, unrolling the ring so the head is back in slot 0
+// (segment i in slot i, which the occupied cells are told about)
+void SnakeSim::growBody() {
+    std::vector<int32_t> grown(body.size() * 2);
+    for (int i = 0; i < bodyLen; ++i) {
+        grown[i] = body[slot(i)];
+        freeSlot[grown[i]] = -1 - i;
+    }
+    body.swap(grown);
+    headSlot = 0;
+}
+
+void SnakeSim::occupyCell(int c, int bodySlot) {
+    int s = freeSlot[c];
+    if (s < 0) return;
+    int last = freeCells[--freeCount];
+    freeCells[s] = last;
+    freeSlot[last] = s;
+    freeSlot[c] = -1 - bodySlot;
+    ++tileSegments[tileOf(c)];
+}
+
+void SnakeSim::releaseCell(int c) {
+    if (freeSlot[c] >= 0) return;
+    freeSlot[c] = freeCount;
+    freeCells[freeCount++] = c;
+    --tileSegments[tileOf(c)];
+}
+
+// Picks a uniform free cell; returns false when the snake covers the whole board
+bool SnakeSim::placeFood() {
+    if (freeCount == 0) { foodCell = -1; return false; }
+    foodCell = freeCells[rng.below(freeCount)];
+    return true;
+}
+
+StepResult SnakeSim::step(Direction action) {
+    if (over) return boardComplete() ? STEP_BOARD_COMPLETE : STEP_DIED;
+    if (action != opposite(dir)) dir = action;
+    ++tickCount;
+
+    Point next = neighbor(head(), dir);
+    int headCell = cellIndex(next.x, next.y);
+    bool eats = (headCell == foodCell);
+    // The tail moves out before the head moves in, so chasing the tail is safe
+    if (!eats) releaseCell(body[slot(bodyLen - 1)]);
+    // Push the new head one slot back; the old tail stays in the slot just past
+    // the body, unless the buffer is full and it is leaving anyway
+    if (eats && bodyLen == (int)body.size()) growBody();
+    headSlot = slot(-1);
+    body[headSlot] = headCell;
+    if (freeSlot[headCell] < 0) {
+        over = true;
+        return STEP_DIED;
+    }
+    occupyCell(headCell, headSlot);
+    if (!eats) return STEP_MOVED;
+
+    // Growing just takes back the old tail slot
+    ++bodyLen;
+    points += 10;
+    if (!placeFood()) {
+        over = true;
+        return STEP_BOARD_COMPLETE;
+    }
+    return STEP_ATE;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "snake_random.h"
+
+// Headless Snake rules: no window, no GL, no globals. The GLFW front end in
+// main.cpp and the headless runner both drive the game through step().
+
+// Opposite directions differ only in the low bit (UP^1 == DOWN, LEFT^1 == RIGHT)
+enum Direction { UP, DOWN, LEFT, RIGHT };
+
+struct Point { int x, y; };
+
+enum StepResult { STEP_MOVED, STEP_ATE, STEP_DIED, STEP_BOARD_COMPLETE };
+
+inline Direction opposite(Direction d) { return (Direction)(d ^ 1); }
+
+// Largest board side; 4096 x 4096 cell indices still fit comfortably in int32
+const int MAX_GRID_SIDE = 4096;
+
+class SnakeSim {
+public:
+    SnakeSim(int width, int height, uint64_t seed = 0, uint64_t stream = 0);
+
+    // Starts a new game: length 1 in the middle of the board, heading right.
+    // Food keeps drawing from the current generator unless a seed is given.
+    void reset();
+    void reset(uint64_t seed, uint64_t stream);
+    // Advances one tick. A 180 degree turn is ignored and the snake keeps going
+    StepResult step(Direction action);
+    StepResult step() { return step(dir); }
+
+    int width() const { return gridW; }
+    int height() const { return gridH; }
+    int cellCount() const { return gridW * gridH; }
+    int length() const { return bodyLen; }
+    int score() const { return points; }
+    long long ticks() const { return tickCount; }
+    Direction direction() const { return dir; }
+    bool finished() const { return over; }
+    bool boardComplete() const { return over && freeCount == 0; }
+
+    bool hasFood() const { return foodCell >= 0; }
+    Point food() const { return cellPoint(foodCell); }
+
+    // Segment 0 is the head, length()-1 the tail
+    Point segment(int i) const { return cellPoint(body[slot(i)]); }
+    Point head() const { return segment(0); }
+    bool isOccupied(int x, int y) const { return freeSlot[cellIndex(x, y)] < 0; }
+    // Index of the segment on cell (x, y), or -1. After a crash the head
+    // shares its cell with the segment it hit, and that one is returned.
+    int segmentAt(int x, int y) const { return segmentAtCell(cellIndex(x, y)); }
+    int segmentAtCell(int c) const {
+        int s = freeSlot[c];
+        return s < 0 ? ((-1 - s) - headSlot) & (int)(body.size() - 1) : -1;
+    }
+
+    // Segments are also counted per TILE x TILE block of cells, so a region
+    // of a large board can be searched for the snake without walking the body
+    static const int TILE = 16;
+    int tilesX() const { return tileCols; }
+    int tilesY() const { return (gridH + TILE - 1) / TILE; }
+    int tileCount(int tx, int ty) const { return tileSegments[ty * tileCols + tx]; }
+
+    // Neighbouring cell in direction d, wrapping around the board edges
+    Point neighbor(Point p, Direction d) const;
+
+    int cellIndex(int x, int y) const { return y * gridW + x; }
+    Point cellPoint(int c) const { return Point{c % gridW, c / gridW}; }
+
+private:
+    int gridW, gridH;
+
+    // Body as a circular buffer of cell indices: segment i lives at
+    // body[(headSlot + i) & (body.size() - 1)], so moving and growing are
+    // O(1). The buffer is a power of two that doubles when the snake
+    // outgrows it, so it follows the snake's length rather than the board's.
+    std::vector<int32_t> body;
+    int headSlot = 0;
+    int bodyLen = 0;
+
+    // Free cells kept dense by swap-remove; freeSlot[c] is the index of c in
+    // freeCells, or -1 - s while the body slot s covers it (which doubles as
+    // the occupancy grid and finds a segment from its cell). These two are
+    // the only per-cell storage, 8 bytes a cell.
+    std::vector<int32_t> freeCells;
+    std::vector<int32_t> freeSlot;
+    int freeCount = 0;
+    int tileCols;
+    std::vector<int32_t> tileSegments;
+
+    Pcg32 rng;
+    int foodCell = -1;
+    Direction dir = RIGHT;
+    int points = 0;
+    long long tickCount = 0;
+    bool over = false;
+
+    int slot(int i) const { return (headSlot + i) & (int)(body.size() - 1); }
+    void growBody();
+    int tileOf(int c) const { return (c / gridW / TILE) * tileCols + c % gridW / TILE; }
+    void occupyCell(int c, int bodySlot);
+    void releaseCell(int c);
+    bool placeFood();
+};
@@ -0,0 +1,270 @@
+#include "soft_raster.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "trace.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFT_RASTER_SSE2 1
+#endif
+
+static uint8_t toByte(float c) {
+    return (uint8_t)(c <= 0.0f ? 0 : (c >= 1.0f ? 255 : c * 255.0f + 0.5f));
+}
+
+// (v + 128) / 255 rounded, exact for v <= 255 * 255
+static inline uint32_t div255(uint32_t v) {
+    v += 128;
+    return (v + (v >> 8)) >> 8;
+}
+
+// Source-over blend of colour c at alpha `alpha` (0-255, colour alpha and
+// coverage already folded in) onto pixels [x0, x1) of a row. Alpha blends
+// like the colour channels, as glBlendFunc(SRC_ALPHA, ONE_MINUS_SRC_ALPHA)
+// does.
+static void blendSpan(uint32_t* row, int x0, int x1, const uint8_t* c, int alpha) {
+    if (alpha <= 0 || x0 >= x1) return;
+    uint32_t* p = row + x0;
+    int n = x1 - x0;
+    if (alpha >= 255) {
+        const uint8_t bytes[4] = {c[0], c[1], c[2], 255};
+        uint32_t v;
+        memcpy(&v, bytes, 4);
+#ifdef SOFT_RASTER_SSE2
+        __m128i fill = _mm_set1_epi32((int)v);
+        for (; n >= 4; n -= 4, p += 4) _mm_storeu_si128((__m128i*)p, fill);
+#endif
+        for (; n > 0; --n) *p++ = v;
+        return;
+    }
+    const uint32_t a = (uint32_t)alpha, inv = 255 - a;
+    const uint32_t src[4] = {c[0] * a, c[1] * a, c[2] * a, a * a};
+#ifdef SOFT_RASTER_SSE2
+    // Two pixels per 8 x 16-bit register: dst * (255 - a) + src * a, then / 255
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i invA = _mm_set1_epi16((short)inv);
+    const __m128i srcA = _mm_set_epi16((short)(src[3] + 128), (short)(src[2] + 128), (short)(src[1] + 128), (short)(src[0] + 128),
+                                       (short)(src[3] + 128), (short)(src[2] + 128), (short)(src[1] + 128), (short)(src[0] + 128));
+    for (; n >= 4; n -= 4, p += 4) {
+        __m128i d = _mm_loadu_si128((const __m128i*)p);
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), invA), srcA);
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), invA), srcA);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+        _mm_storeu_si128((__m128i*)p, _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; n > 0; --n, ++p) {
+        uint8_t* d = (uint8_t*)p;
+        for (int k = 0; k < 4; ++k) d[k] = (uint8_t)div255(d[k] * inv + src[k]);
+    }
+}
+
+// Covers [left, right) in continuous pixel x, limited to [x0, x1): whole
+// pixels at full alpha, the end pixels by the fraction of them covered
+static void coverSpan(uint32_t* row, float left, float right, int x0, int x1, const uint8_t* c, int alpha) {
+    if (right <= left) return;
+    int il = (int)std::floor(left), ir = (int)std::floor(right);
+    if (il == ir) {
+        if (il >= x0 && il < x1) blendSpan(row, il, il + 1, c, (int)(alpha * (right - left) + 0.5f));
+        return;
+    }
+    if (il >= x0 && il < x1) blendSpan(row, il, il + 1, c, (int)(alpha * (il + 1 - left) + 0.5f));
+    blendSpan(row, std::max(il + 1, x0), std::min(ir, x1), c, alpha);
+    if (ir >= x0 && ir < x1) blendSpan(row, ir, ir + 1, c, (int)(alpha * (right - ir) + 0.5f));
+}
+
+// First pixel whose centre is at or right of continuous coordinate v
+static inline int firstCentre(float v) { return (int)std::ceil(v - 0.5f); }
+
+SoftRaster::SoftRaster(int threads) {
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    for (int i = 1; i < threads; ++i) workers.emplace_back(&SoftRaster::workerLoop, this);
+}
+
+SoftRaster::~SoftRaster() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+void SoftRaster::resize(int width, int height) {
+    if (width == fbWidth && height == fbHeight) return;
+    fbWidth = width;
+    fbHeight = height;
+    framebuffer.assign((size_t)width * height, 0);
+    tilesX = (width + TILE - 1) / TILE;
+    tilesY = (height + TILE - 1) / TILE;
+    tileShapes.assign((size_t)tilesX * tilesY, std::vector<uint32_t>());
+    clearClip();
+}
+
+void SoftRaster::setClip(int x, int y, int w, int h) {
+    clipX0 = std::max(x, 0);
+    clipY0 = std::max(y, 0);
+    clipX1 = std::min(x + w, fbWidth);
+    clipY1 = std::min(y + h, fbHeight);
+}
+
+SoftRaster::Shape& SoftRaster::add(float x, float y, float halfW, float halfH, float r, float g, float b, float a, Kind kind) {
+    Shape s;
+    s.x = x; s.y = y; s.halfW = halfW; s.halfH = halfH;
+    s.param = 0.0f;
+    s.color[0] = toByte(r); s.color[1] = toByte(g); s.color[2] = toByte(b); s.color[3] = toByte(a);
+    memcpy(s.color2, s.color, 4);
+    s.kind = kind;
+    float sx = 0.5f * fbWidth, sy = 0.5f * fbHeight;
+    float left = (x - halfW + 1.0f) * sx, right = (x + halfW + 1.0f) * sx;
+    float bottom = (y - halfH + 1.0f) * sy, top = (y + halfH + 1.0f) * sy;
+    if (kind == CIRCLE || kind == ROUNDED_RECT) {
+        // Edge pixels are partly covered
+        s.x0 = (int)std::floor(left); s.x1 = (int)std::ceil(right);
+        s.y0 = firstCentre(bottom); s.y1 = firstCentre(top);
+    } else {
+        s.x0 = firstCentre(left); s.x1 = firstCentre(right);
+        s.y0 = firstCentre(bottom); s.y1 = firstCentre(top);
+    }
+    s.x0 = std::max(s.x0, clipX0); s.x1 = std::min(s.x1, clipX1);
+    s.y0 = std::max(s.y0, clipY0); s.y1 = std::min(s.y1, clipY1);
+    shapes.push_back(s);
+    return shapes.back();
+}
+
+void SoftRaster::circle(float x, float y, float radius, float r, float g, float b, float a) {
+    add(x, y, radius, radius, r, g, b, a, CIRCLE);
+}
+
+void SoftRaster::rect(float x, float y, float halfW, float halfH, float r, float g, float b, float a) {
+    add(x, y, halfW, halfH, r, g, b, a, RECT);
+}
+
+void SoftRaster::roundedRect(float x, float y, float halfW, float halfH, float radius, float r, float g, float b, float a) {
+    add(x, y, halfW, halfH, r, g, b, a, ROUNDED_RECT).param = std::min(radius, std::min(halfW, halfH));
+}
+
+void SoftRaster::gradient(float x, float y, float halfW, float halfH, const float* top, const float* bottom) {
+    Shape& s = add(x, y, halfW, halfH, top[0], top[1], top[2], top[3], GRADIENT);
+    for (int k = 0; k < 4; ++k) s.color2[k] = toByte(bottom[k]);
+}
+
+void SoftRaster::glyph(float x, float y, float halfW, float halfH, unsigned char c, float r, float g, float b, float a) {
+    if (c < 128 && glyphRows) add(x, y, halfW, halfH, r, g, b, a, GLYPH).param = c;
+}
+
+void SoftRaster::flush() {
+    TRACE_SCOPE("softRasterFlush");
+    if (shapes.empty() || tileShapes.empty()) { shapes.clear(); return; }
+    for (auto& list : tileShapes) list.clear();
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        const Shape& s = shapes[i];
+        if (s.x0 >= s.x1 || s.y0 >= s.y1) continue;
+        for (int ty = s.y0 / TILE; ty <= (s.y1 - 1) / TILE; ++ty)
+            for (int tx = s.x0 / TILE; tx <= (s.x1 - 1) / TILE; ++tx)
+                tileShapes[ty * tilesX + tx].push_back((uint32_t)i);
+    }
+
+    nextTile = 0;
+    if (!workers.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++generation;
+            busyWorkers = (int)workers.size();
+        }
+        wake.notify_all();
+    }
+    drawTiles();
+    if (!workers.empty()) {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return busyWorkers == 0; });
+    }
+    shapes.clear();
+}
+
+void SoftRaster::workerLoop() {
+    trace::setThreadName("raster");
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        drawTiles();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0) done.notify_one();
+    }
+}
+
+void SoftRaster::drawTiles() {
+    TRACE_SCOPE("drawTiles");
+    const int count = tilesX * tilesY;
+    for (int t; (t = nextTile.fetch_add(1)) < count;) drawTile(t);
+}
+
+void SoftRaster::drawTile(int tile) {
+    int x0 = (tile % tilesX) * TILE, y0 = (tile / tilesX) * TILE;
+    int x1 = std::min(x0 + TILE, fbWidth), y1 = std::min(y0 + TILE, fbHeight);
+    for (uint32_t i : tileShapes[tile]) {
+        const Shape& s = shapes[i];
+        drawShape(s, std::max(x0, s.x0), std::max(y0, s.y0), std::min(x1, s.x1), std::min(y1, s.y1));
+    }
+}
+
+// One span per pixel row of [x0, x1) x [y0, y1), sampled at pixel centres
+void SoftRaster::drawShape(const Shape& s, int x0, int y0, int x1, int y1) {
+    const float sx = 0.5f * fbWidth, sy = 0.5f * fbHeight;
+    for (int py = y0; py < y1; ++py) {
+        uint32_t* row = framebuffer.data() + (size_t)py * fbWidth;
+        float dy = (py + 0.5f) / sy - 1.0f - s.y;  // NDC from the centre
+        switch (s.kind) {
+            case RECT:
+                blendSpan(row, x0, x1, s.color, s.color[3]);
+                break;
+            case GRADIENT: {
+                float t = std::min(std::max((dy + s.halfH) / (2.0f * s.halfH), 0.0f), 1.0f);
+                uint8_t c[4];
+                for (int k = 0; k < 4; ++k) c[k] = toByte((s.color2[k] + t * (s.color[k] - s.color2[k])) / 255.0f);
+                blendSpan(row, x0, x1, c, c[3]);
+                break;
+            }
+            case CIRCLE: {
+                float r = s.halfW;
+                if (std::fabs(dy) >= r) break;
+                float ex = std::sqrt(r * r - dy * dy);
+                coverSpan(row, (s.x - ex + 1.0f) * sx, (s.x + ex + 1.0f) * sx, x0, x1, s.color, s.color[3]);
+                break;
+            }
+            case ROUNDED_RECT: {
+                float r = s.param, ay = std::fabs(dy), inner = s.halfH - r;
+                if (ay >= s.halfH) break;
+                float ex = ay <= inner ? s.halfW : s.halfW - r + std::sqrt(r * r - (ay - inner) * (ay - inner));
+                coverSpan(row, (s.x - ex + 1.0f) * sx, (s.x + ex + 1.0f) * sx, x0, x1, s.color, s.color[3]);
+                break;
+            }
+            case GLYPH: {
+                // Runs of lit columns in this glyph row become one span each
+                float v = (dy + s.halfH) / (2.0f * s.halfH);
+                int glyphRow = std::min(std::max((int)((1.0f - v) * 7.0f), 0), 6);
+                uint8_t bits = glyphRows[(int)s.param * 7 + glyphRow];
+                float left = (s.x - s.halfW + 1.0f) * sx, column = 2.0f * s.halfW * sx / 5.0f;
+                for (int col = 0; col < 5;) {
+                    if (!(bits >> (4 - col) & 1)) { ++col; continue; }
+                    int end = col;
+                    while (end < 5 && (bits >> (4 - end) & 1)) ++end;
+                    int from = std::max(firstCentre(left + col * column), x0);
+                    int to = std::min(firstCentre(left + end * column), x1);
+                    blendSpan(row, from, to, s.color, s.color[3]);
+                    col = end;
+                }
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Draws the shapes ShapeBatch draws (circles, rectangles, rounded
+// rectangles, vertical gradients and font glyphs) into an RGBA8 framebuffer
+// in memory, with no GL. Shapes added since the last flush are binned into
+// TILE x TILE pixel tiles; flush() then has a pool of threads take tiles off
+// a shared counter and draw each tile's shapes in the order they were added,
+// so output is the same for any thread count. Every shape becomes one
+// horizontal span per pixel row, blended (source alpha over) four pixels at
+// a time with SSE2 where available.
+//
+// Pixels are sampled at their centres like GL; circles and rounded corners
+// get horizontal edge coverage at the ends of each span instead of the
+// shader's distance-field antialiasing, so edges differ from the GL path by
+// a little, interiors not at all.
+class SoftRaster {
+public:
+    static const int TILE = 64;
+
+    // 0 = one thread per hardware thread (the caller counts as one)
+    explicit SoftRaster(int threads = 0);
+    ~SoftRaster();
+    SoftRaster(const SoftRaster&) = delete;
+    SoftRaster& operator=(const SoftRaster&) = delete;
+
+    // Reallocates and clears to transparent black when the size changes
+    void resize(int width, int height);
+    int width() const { return fbWidth; }
+    int height() const { return fbHeight; }
+    int threads() const { return (int)workers.size() + 1; }
+    // width * height RGBA8, bottom row first as glReadPixels returns them
+    const uint8_t* pixels() const { return (const uint8_t*)framebuffer.data(); }
+    // Whole-framebuffer copies, to keep a drawn background between frames
+    void copyTo(std::vector<uint32_t>& layer) const { layer = framebuffer; }
+    void copyFrom(const std::vector<uint32_t>& layer) {
+        if (layer.size() == framebuffer.size()) framebuffer = layer;
+    }
+
+    // 128 glyphs of 7 row bitmasks each, bit 4 the leftmost of 5 columns;
+    // must stay valid while glyphs are drawn
+    void setGlyphs(const uint8_t* rows) { glyphRows = rows; }
+    // Shapes added from now on are clipped to this pixel rectangle, given as
+    // for glScissor (origin bottom left)
+    void setClip(int x, int y, int w, int h);
+    void clearClip() { setClip(0, 0, fbWidth, fbHeight); }
+
+    void begin() { shapes.clear(); }
+    // Same arguments as ShapeBatch: centre and radius/half size in NDC
+    void circle(float x, float y, float radius, float r, float g, float b, float a);
+    void square(float x, float y, float halfSize, float r, float g, float b, float a) {
+        rect(x, y, halfSize, halfSize, r, g, b, a);
+    }
+    void rect(float x, float y, float halfW, float halfH, float r, float g, float b, float a);
+    void roundedRect(float x, float y, float halfW, float halfH, float radius, float r, float g, float b, float a);
+    void gradient(float x, float y, float halfW, float halfH, const float* top, const float* bottom);
+    void glyph(float x, float y, float halfW, float halfH, unsigned char c, float r, float g, float b, float a);
+    // Draws everything added since the last flush and empties the list
+    void flush();
+
+    size_t size() const { return shapes.size(); }
+
+private:
+    enum Kind : uint8_t { CIRCLE, RECT, ROUNDED_RECT, GLYPH, GRADIENT };
+    struct Shape {
+        float x, y, halfW, halfH;
+        float param;  // corner radius or glyph code
+        uint8_t color[4];
+        uint8_t color2[4];  // gradient bottom
+        Kind kind;
+        int x0, y0, x1, y1;  // pixels it may touch, clip applied, exclusive ends
+    };
+    std::vector<Shape> shapes;
+    std::vector<uint32_t> framebuffer;
+    int fbWidth = 0, fbHeight = 0;
+    int clipX0 = 0, clipY0 = 0, clipX1 = 0, clipY1 = 0;
+    const uint8_t* glyphRows = nullptr;
+
+    // Shape indices per tile, rebuilt by every flush
+    int tilesX = 0, tilesY = 0;
+    std::vector<std::vector<uint32_t>> tileShapes;
+
+    // Worker pool: flush() bumps `generation` and every thread, the caller
+    // included, draws tiles until `nextTile` runs past the end
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    uint64_t generation = 0;
+    int busyWorkers = 0;
+    bool stopping = false;
+    std::atomic<int> nextTile{0};
+
+    Shape& add(float x, float y, float halfW, float halfH, float r, float g, float b, float a, Kind kind);
+    void workerLoop();
+    void drawTiles();
+    void drawTile(int tile);
+    void drawShape(const Shape& s, int x0, int y0, int x1, int y1);
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+// Timeline tracing shared by the Snake game and the vault. Spans are
+// compiled in only when ENABLE_TRACE is defined (cmake -DENABLE_TRACE=ON);
+// otherwise TRACE_SCOPE expands to nothing and write() reports failure.
+//
+// Each thread records completed spans into its own ring buffer of the last
+// ThreadBuffer::CAPACITY events: a record is a slot store and a release
+// increment, no locks and no allocation after the thread's first span.
+// Buffers link into a global list on first use and are never freed, so
+// write() can still export threads that have exited. write() emits Chrome
+// trace JSON, which loads in chrome://tracing and ui.perfetto.dev.
+//
+// Span names must be string literals (only the pointer is stored).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace trace {
+
+#ifdef ENABLE_TRACE
+
+struct Event {
+    const char* name;
+    int64_t begin, end;  // ns since the trace epoch
+};
+
+struct ThreadBuffer {
+    static const uint64_t CAPACITY = 1 << 16;
+    Event events[CAPACITY];
+    std::atomic<uint64_t> written{0};
+    uint32_t tid = 0;
+    const char* threadName = nullptr;
+    ThreadBuffer* next = nullptr;
+};
+
+inline std::atomic<ThreadBuffer*> buffers{nullptr};
+inline std::atomic<uint32_t> nextTid{1};
+inline const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+inline int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+inline ThreadBuffer& threadBuffer() {
+    thread_local ThreadBuffer* buffer = [] {
+        ThreadBuffer* b = new ThreadBuffer;
+        b->tid = nextTid.fetch_add(1, std::memory_order_relaxed);
+        b->next = buffers.load(std::memory_order_relaxed);
+        while (!buffers.compare_exchange_weak(b->next, b, std::memory_order_release, std::memory_order_relaxed)) {}
+        return b;
+    }();
+    return *buffer;
+}
+
+inline void record(const char* name, int64_t begin, int64_t end) {
+    ThreadBuffer& b = threadBuffer();
+    uint64_t n = b.written.load(std::memory_order_relaxed);
+    b.events[n & (ThreadBuffer::CAPACITY - 1)] = Event{name, begin, end};
+    b.written.store(n + 1, std::memory_order_release);
+}
+
+class Span {
+public:
+    explicit Span(const char* name) : name(name), begin(now()) {}
+    ~Span() { record(name, begin, now()); }
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* name;
+    int64_t begin;
+};
+
+inline void setThreadName(const char* name) { threadBuffer().threadName = name; }
+
+// Call once the threads that record have stopped or been joined; event
+// slots are plain stores, not synchronised with this copy. As a guard, any
+// slot a late writer may have been reusing during the copy (including the
+// one it stores before bumping `written`) is dropped rather than exported.
+inline bool write(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    std::vector<Event> copy;
+    for (ThreadBuffer* b = buffers.load(std::memory_order_acquire); b; b = b->next) {
+        uint64_t n = b->written.load(std::memory_order_acquire);
+        uint64_t start = n > ThreadBuffer::CAPACITY ? n - ThreadBuffer::CAPACITY : 0;
+        copy.assign(n - start, Event());
+        for (uint64_t i = start; i < n; ++i) copy[i - start] = b->events[i & (ThreadBuffer::CAPACITY - 1)];
+        uint64_t after = b->written.load(std::memory_order_acquire);
+        uint64_t valid = after >= ThreadBuffer::CAPACITY ? after - ThreadBuffer::CAPACITY + 1 : 0;
+        if (b->threadName) {
+            fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                    first ? "" : ",\n", b->tid, b->threadName);
+            first = false;
+        }
+        for (uint64_t i = std::max(start, valid); i < n; ++i) {
+            const Event& e = copy[i - start];
+            fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    first ? "" : ",\n", e.name, b->tid, e.begin / 1000.0, (e.end - e.begin) / 1000.0);
+            first = false;
+        }
+    }
+    fprintf(f, "\n]}\n");
+    return fclose(f) == 0;
+}
+
+#else
+
+inline void setThreadName(const char*) {}
+inline bool write(const char*) { return false; }
+
+#endif
+
+}  // namespace trace
+
+#ifdef ENABLE_TRACE
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) trace::Span TRACE_CONCAT(traceSpan, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#endif